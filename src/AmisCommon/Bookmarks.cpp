@@ -56,6 +56,9 @@ amis::BookmarkFile::BookmarkFile()
 {
     mpLastmark = NULL;
     mpTitle = NULL;
+    mMaxId = 0;
+    mbMaxIdValid = true;
+    mJournalGeneration = 0;
 }
 
 amis::BookmarkFile::~BookmarkFile()
@@ -146,6 +149,9 @@ int amis::BookmarkFile::getNumberOfItems()
 
 int amis::BookmarkFile::getMaxId()
 {
+    if (mbMaxIdValid)
+        return mMaxId;
+
     int i, id;
     int sz = mItems.size();
     int maxId = 0;
@@ -164,6 +170,9 @@ int amis::BookmarkFile::getMaxId()
         }
     }
 
+    mMaxId = maxId;
+    mbMaxIdValid = true;
+
     return maxId;
 }
 
@@ -204,6 +213,9 @@ void amis::BookmarkFile::addHilite(Hilite* pHilite)
 void amis::BookmarkFile::addBookmark(Bookmark* pBookmark)
 {
     mItems.push_back(pBookmark);
+
+    if (mbMaxIdValid && pBookmark->mId > mMaxId)
+        mMaxId = pBookmark->mId;
 }
 
 void amis::BookmarkFile::deleteItem(int idx)
@@ -211,6 +223,11 @@ void amis::BookmarkFile::deleteItem(int idx)
     LOG4CXX_INFO( amisBookmarksLog, "Erasing bookmark: " << idx);
     PositionMark* posmark = mItems[idx];
     mItems.erase(mItems.begin() + idx);
+
+    if (posmark->mType == amis::PositionMark::BOOKMARK
+            && ((amis::Bookmark*) posmark)->mId >= mMaxId)
+        mbMaxIdValid = false;
+
     delete posmark;
 }
 
@@ -234,6 +251,16 @@ void amis::BookmarkFile::setLastmark(amis::PositionData* pData)
     mpLastmark = pData;
 }
 
+int amis::BookmarkFile::getJournalGeneration()
+{
+    return mJournalGeneration;
+}
+
+void amis::BookmarkFile::setJournalGeneration(int generation)
+{
+    mJournalGeneration = generation;
+}
+
 void amis::BookmarkFile::print()
 {
     stringstream ssbookmark;
@@ -151,11 +151,21 @@ public:
     void setUid(std::string);
     void setLastmark(amis::PositionData*);
 
+    int getJournalGeneration();
+    void setJournalGeneration(int);
+
 private:
     amis::MediaGroup* mpTitle;
     std::string mUid;
     PositionData* mpLastmark;
 
+    //highest bookmark id, recounted after the bookmark holding it is deleted
+    int mMaxId;
+    bool mbMaxIdValid;
+
+    //the bookmarks journal that goes with this file, see BookmarksJournal
+    int mJournalGeneration;
+
     //bookmarks and hilites
     std::vector<amis::PositionMark*> mItems;
 
@@ -0,0 +1,537 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "BookmarksJournal.h"
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <cstdlib>
+#include <cstdio>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <log4cxx/logger.h>
+
+// create logger which will become a child to logger kolibre.amis
+log4cxx::LoggerPtr amisBmkJournalLog(
+        log4cxx::Logger::getLogger("kolibre.amis.bookmarksjournal"));
+
+using namespace std;
+
+// fields in a position data record
+#define POSITION_FIELDS 9
+
+// split a record into its fields and undo the escaping of tabs, newlines
+// and backslashes
+static void splitRecord(const string& record, vector<string>& fields)
+{
+    fields.clear();
+    string field;
+    for (unsigned int i = 0; i < record.size(); i++)
+    {
+        char c = record[i];
+        if (c == '\t')
+        {
+            fields.push_back(field);
+            field.erase();
+        }
+        else if (c == '\\' && i + 1 < record.size())
+        {
+            c = record[++i];
+            if (c == 't')
+                field += '\t';
+            else if (c == 'n')
+                field += '\n';
+            else
+                field += c;
+        }
+        else
+        {
+            field += c;
+        }
+    }
+    fields.push_back(field);
+}
+
+static bool toInt(const string& field, int& value)
+{
+    if (field.empty())
+        return false;
+
+    char* end = NULL;
+    long l = strtol(field.c_str(), &end, 10);
+    if (*end != '\0')
+        return false;
+
+    value = (int) l;
+    return true;
+}
+
+static string fromInt(int value)
+{
+    ostringstream oss;
+    oss << value;
+    return oss.str();
+}
+
+amis::BookmarksJournal::BookmarksJournal()
+{
+    mFd = -1;
+    mNumRecords = 0;
+}
+
+amis::BookmarksJournal::~BookmarksJournal()
+{
+    close();
+}
+
+/**
+ * Get the path of the journal that goes with a bookmark file
+ *
+ * @param bookmarkFilePath Path of the bookmark file
+ * @return Returns the path of the journal
+ */
+string amis::BookmarksJournal::getJournalPath(string bookmarkFilePath)
+{
+    return bookmarkFilePath + ".journal";
+}
+
+/**
+ * Apply the journal of a bookmark file and open it for appending
+ *
+ * A journal left from an earlier generation, or a missing one, is replaced
+ * by an empty journal for the generation of the bookmark file.
+ *
+ * @param bookmarkFilePath Path of the bookmark file
+ * @param pFile The bookmark file as read from disk
+ * @return Returns OK or UNDEFINED_ERROR if the journal can't be written
+ */
+amis::AmisError amis::BookmarksJournal::open(string bookmarkFilePath,
+        BookmarkFile* pFile)
+{
+    AmisError err;
+    err.setSourceModuleName(amis::module_AmisCommon);
+
+    close();
+    mFilePath = getJournalPath(bookmarkFilePath);
+    mNumRecords = 0;
+
+    ifstream in(mFilePath.c_str(), ios::in | ios::binary);
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();
+
+    //check that the journal continues the bookmark file
+    bool b_current = false;
+    string::size_type pos = data.find('\n');
+    if (pos != string::npos)
+    {
+        vector<string> fields;
+        splitRecord(data.substr(0, pos), fields);
+        int generation;
+        if (fields.size() == 2 && fields[0] == "J"
+                && toInt(fields[1], generation)
+                && generation == pFile->getJournalGeneration())
+            b_current = true;
+    }
+
+    if (b_current == false)
+    {
+        if (data.size() > 0)
+            LOG4CXX_INFO(amisBmkJournalLog,
+                    "Discarding journal already in the bookmark file " << mFilePath);
+
+        if (not reset(pFile->getJournalGeneration()))
+        {
+            err.setCode(amis::UNDEFINED_ERROR);
+            err.setMessage("Failed to create bookmarks journal");
+            err.setFilename(mFilePath);
+        }
+        return err;
+    }
+
+    //apply complete records, a cut off one ends the journal
+    string::size_type valid = ++pos;
+    string::size_type eol;
+    while ((eol = data.find('\n', pos)) != string::npos)
+    {
+        if (not applyRecord(data.substr(pos, eol - pos), pFile))
+        {
+            LOG4CXX_WARN(amisBmkJournalLog,
+                    "Bad record " << mNumRecords + 1 << " in " << mFilePath);
+            break;
+        }
+        mNumRecords++;
+        pos = eol + 1;
+        valid = pos;
+    }
+
+    if (valid < data.size())
+        LOG4CXX_WARN(amisBmkJournalLog,
+                "Dropping " << data.size() - valid << " bytes at the end of " << mFilePath);
+
+    LOG4CXX_DEBUG(amisBmkJournalLog,
+            "Applied " << mNumRecords << " records from " << mFilePath);
+
+    mFd = ::open(mFilePath.c_str(), O_WRONLY | O_APPEND);
+    if (mFd < 0 || ftruncate(mFd, valid) != 0)
+    {
+        LOG4CXX_ERROR(amisBmkJournalLog, "Failed to open " << mFilePath);
+        close();
+        err.setCode(amis::UNDEFINED_ERROR);
+        err.setMessage("Failed to open bookmarks journal");
+        err.setFilename(mFilePath);
+    }
+
+    return err;
+}
+
+/**
+ * Close the journal, records already appended stay on disk
+ */
+void amis::BookmarksJournal::close()
+{
+    if (mFd >= 0)
+    {
+        ::close(mFd);
+        mFd = -1;
+    }
+}
+
+bool amis::BookmarksJournal::isOpen()
+{
+    return mFd >= 0;
+}
+
+/**
+ * Start an empty journal, called after the bookmark file has been written
+ *
+ * @param generation The journal generation stored in the bookmark file
+ * @return Returns true on success
+ */
+bool amis::BookmarksJournal::reset(int generation)
+{
+    close();
+    mNumRecords = 0;
+
+    mFd = ::open(mFilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND,
+            0644);
+    if (mFd < 0)
+    {
+        LOG4CXX_ERROR(amisBmkJournalLog, "Failed to create " << mFilePath);
+        return false;
+    }
+
+    string header = "J\t" + fromInt(generation) + "\n";
+    if (::write(mFd, header.data(), header.size()) != (ssize_t) header.size()
+            || fsync(mFd) != 0)
+    {
+        LOG4CXX_ERROR(amisBmkJournalLog, "Failed to write " << mFilePath);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Close the journal and delete it from disk
+ *
+ * @return Returns true if the journal is gone
+ */
+bool amis::BookmarksJournal::remove()
+{
+    close();
+    mNumRecords = 0;
+
+    if (unlink(mFilePath.c_str()) != 0 && errno != ENOENT)
+    {
+        LOG4CXX_WARN(amisBmkJournalLog, "Failed to remove " << mFilePath);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Append a record and flush it to disk
+ *
+ * @param record A record from one of the record functions
+ * @return Returns true on success
+ */
+bool amis::BookmarksJournal::append(const string& record)
+{
+    if (mFd < 0)
+        return false;
+
+    const char* p_data = record.data();
+    size_t remaining = record.size();
+    while (remaining > 0)
+    {
+        ssize_t written = ::write(mFd, p_data, remaining);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+        {
+            LOG4CXX_ERROR(amisBmkJournalLog, "Failed to append to " << mFilePath);
+            return false;
+        }
+        p_data += written;
+        remaining -= written;
+    }
+
+    if (fdatasync(mFd) != 0)
+    {
+        LOG4CXX_ERROR(amisBmkJournalLog, "Failed to sync " << mFilePath);
+        return false;
+    }
+
+    mNumRecords++;
+    return true;
+}
+
+/**
+ * Get the number of records since the journal was last compacted
+ */
+unsigned int amis::BookmarksJournal::getNumberOfRecords()
+{
+    return mNumRecords;
+}
+
+/**
+ * Format a record which replaces the lastmark
+ */
+string amis::BookmarksJournal::lastmarkRecord(PositionData* pData)
+{
+    string record = "L";
+    appendPositionData(record, pData);
+    record += '\n';
+    return record;
+}
+
+/**
+ * Format a record which adds a bookmark
+ */
+string amis::BookmarksJournal::bookmarkRecord(Bookmark* pBookmark)
+{
+    string record = "B";
+    appendField(record, fromInt(pBookmark->mId));
+    appendPositionData(record, pBookmark->mpStart);
+
+    MediaGroup* p_note = pBookmark->mbHasNote ? pBookmark->mpNote : NULL;
+    appendField(record, p_note != NULL ? "1" : "0");
+    if (p_note != NULL)
+    {
+        bool b_text = p_note->hasText();
+        appendField(record, b_text ? "1" : "0");
+        appendField(record, b_text ? p_note->getText()->getTextString() : "");
+
+        unsigned int num_clips = p_note->getNumberOfAudioClips();
+        appendField(record, fromInt(num_clips));
+        for (unsigned int i = 0; i < num_clips; i++)
+        {
+            AudioNode* p_audio = p_note->getAudio(i);
+            appendField(record, p_audio->getSrc());
+            appendField(record, p_audio->getClipBegin());
+            appendField(record, p_audio->getClipEnd());
+        }
+    }
+
+    record += '\n';
+    return record;
+}
+
+/**
+ * Format a record which deletes the item at an index
+ */
+string amis::BookmarksJournal::deleteRecord(int idx)
+{
+    return "D\t" + fromInt(idx) + "\n";
+}
+
+/**
+ * Format a record which deletes all items
+ */
+string amis::BookmarksJournal::deleteAllRecord()
+{
+    return "C\n";
+}
+
+/**
+ * Apply one record to a bookmark file
+ *
+ * @return Returns false if the record is malformed
+ */
+bool amis::BookmarksJournal::applyRecord(const string& record,
+        BookmarkFile* pFile)
+{
+    vector<string> fields;
+    splitRecord(record, fields);
+
+    unsigned int field = 1;
+    if (fields[0] == "L")
+    {
+        PositionData* p_pos = readPositionData(fields, field);
+        if (p_pos == NULL || field != fields.size())
+        {
+            delete p_pos;
+            return false;
+        }
+        pFile->setLastmark(p_pos);
+    }
+    else if (fields[0] == "B")
+    {
+        int id;
+        if (fields.size() < 2 || not toInt(fields[field++], id))
+            return false;
+
+        PositionData* p_pos = readPositionData(fields, field);
+        if (p_pos == NULL || field >= fields.size())
+        {
+            delete p_pos;
+            return false;
+        }
+
+        MediaGroup* p_note = NULL;
+        bool b_ok = true;
+        if (fields[field++] == "1")
+        {
+            int num_clips = 0;
+            b_ok = field + 3 <= fields.size()
+                    && toInt(fields[field + 2], num_clips) && num_clips >= 0
+                    && field + 3 + 3 * num_clips == fields.size();
+            if (b_ok)
+            {
+                p_note = new MediaGroup();
+                if (fields[field] == "1")
+                {
+                    TextNode* p_text = new TextNode();
+                    p_text->setTextString(fields[field + 1]);
+                    p_note->setText(p_text);
+                }
+                field += 3;
+                for (int i = 0; i < num_clips; i++)
+                {
+                    AudioNode* p_audio = new AudioNode();
+                    p_audio->setSrc(fields[field++]);
+                    p_audio->setClipBegin(fields[field++]);
+                    p_audio->setClipEnd(fields[field++]);
+                    p_note->addAudioClip(p_audio);
+                }
+            }
+        }
+        else
+        {
+            b_ok = field == fields.size();
+        }
+
+        if (not b_ok)
+        {
+            delete p_pos;
+            return false;
+        }
+
+        Bookmark* p_bmk = new Bookmark();
+        p_bmk->mId = id;
+        p_bmk->mpStart = p_pos;
+        p_bmk->mpNote = p_note;
+        p_bmk->mbHasNote = p_note != NULL;
+        pFile->addBookmark(p_bmk);
+    }
+    else if (fields[0] == "D")
+    {
+        int idx;
+        if (fields.size() != 2 || not toInt(fields[1], idx))
+            return false;
+        if (idx < 0 || idx >= pFile->getNumberOfItems())
+            return false;
+        pFile->deleteItem(idx);
+    }
+    else if (fields[0] == "C")
+    {
+        if (fields.size() != 1)
+            return false;
+        while (pFile->getNumberOfItems() > 0)
+            pFile->deleteItem(pFile->getNumberOfItems() - 1);
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void amis::BookmarksJournal::appendPositionData(string& record,
+        PositionData* pData)
+{
+    appendField(record, pData->mUri);
+    appendField(record, pData->mNcxRef);
+    appendField(record, pData->mTextRef);
+    appendField(record, pData->mAudioRef);
+    appendField(record, fromInt(pData->mPlayOrder));
+    appendField(record, pData->mbHasTimeOffset ? "1" : "0");
+    appendField(record, pData->mTimeOffset);
+    appendField(record, pData->mbHasCharOffset ? "1" : "0");
+    appendField(record, pData->mCharOffset);
+}
+
+amis::PositionData* amis::BookmarksJournal::readPositionData(
+        const vector<string>& fields, unsigned int& field)
+{
+    if (field + POSITION_FIELDS > fields.size())
+        return NULL;
+
+    PositionData* p_pos = new PositionData();
+    p_pos->mUri = fields[field];
+    p_pos->mNcxRef = fields[field + 1];
+    p_pos->mTextRef = fields[field + 2];
+    p_pos->mAudioRef = fields[field + 3];
+    if (not toInt(fields[field + 4], p_pos->mPlayOrder))
+    {
+        delete p_pos;
+        return NULL;
+    }
+    p_pos->mbHasTimeOffset = fields[field + 5] == "1";
+    p_pos->mTimeOffset = fields[field + 6];
+    p_pos->mbHasCharOffset = fields[field + 7] == "1";
+    p_pos->mCharOffset = fields[field + 8];
+
+    field += POSITION_FIELDS;
+    return p_pos;
+}
+
+// append a tab and the field with tabs, newlines and backslashes escaped
+void amis::BookmarksJournal::appendField(string& record, const string& value)
+{
+    record += '\t';
+    for (unsigned int i = 0; i < value.size(); i++)
+    {
+        char c = value[i];
+        if (c == '\t')
+            record += "\\t";
+        else if (c == '\n')
+            record += "\\n";
+        else if (c == '\\')
+            record += "\\\\";
+        else
+            record += c;
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BOOKMARKSJOURNAL_H
+#define BOOKMARKSJOURNAL_H
+
+#include "AmisCommon.h"
+#include "AmisError.h"
+#include "Bookmarks.h"
+
+#include <string>
+#include <vector>
+
+namespace amis
+{
+
+//! The Bookmarks Journal records bookmark file changes as appended lines
+/*!
+ The journal lives next to the bookmark file, in "<file>.journal". Every
+ change to the bookmark file is appended as one line of tab separated
+ fields, so saving a change costs the same however many bookmarks the file
+ holds. The journal is compacted by writing the whole bookmark file and
+ starting a new, empty journal.
+
+ The first line holds the journal generation. The bookmark file stores the
+ generation of the journal that continues it, a journal with any other
+ generation was already compacted into the file and is discarded. Lines
+ that are cut short, e.g. by a power cut while appending, end the replay.
+ */
+class AMISCOMMON_API BookmarksJournal
+{
+public:
+    BookmarksJournal();
+    ~BookmarksJournal();
+
+    AmisError open(std::string, BookmarkFile*);
+    void close();
+    bool isOpen();
+    bool reset(int);
+    bool remove();
+
+    bool append(const std::string&);
+    unsigned int getNumberOfRecords();
+
+    static std::string getJournalPath(std::string);
+
+    std::string lastmarkRecord(PositionData*);
+    std::string bookmarkRecord(Bookmark*);
+    std::string deleteRecord(int);
+    std::string deleteAllRecord();
+
+private:
+    bool applyRecord(const std::string&, BookmarkFile*);
+    void appendPositionData(std::string&, PositionData*);
+    PositionData* readPositionData(const std::vector<std::string>&,
+            unsigned int&);
+    void appendField(std::string&, const std::string&);
+
+    std::string mFilePath;
+    int mFd;
+    unsigned int mNumRecords;
+};
+
+}
+
+#endif
@@ -134,7 +134,13 @@ bool amis::BookmarksReader::startElement(const xmlChar* const uri,
 
     mpAttributes = &attributes;
 
-    if (strcmp(element_name, "title") == 0)
+    if (strcmp(element_name, "bookmarkSet") == 0)
+    {
+        string generation = getAttributeValue("journal");
+        if (generation.size() > 0)
+            mpFile->setJournalGeneration(stringTo<int>(generation));
+    }
+    else if (strcmp(element_name, "title") == 0)
     {
         mpTitle = new amis::MediaGroup();
     }
@@ -28,6 +28,9 @@
 #include <libxml/xmlwriter.h>
 
 #include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
 #include <log4cxx/logger.h>
 
 // create logger which will become a child to logger kolibre.amis
@@ -82,20 +85,45 @@ private:
 //end of borrowed Xerces Code.
 
 amis::BookmarksWriter::BookmarksWriter() :
-        xmlwriter(0)
+        xmlwriter(0), mpDoc(0)
 {
 }
 
 amis::BookmarksWriter::~BookmarksWriter()
 {
+    if (mpDoc != NULL)
+        xmlFreeDoc(mpDoc);
 }
 
 bool amis::BookmarksWriter::saveFile(string filepath, BookmarkFile* pFile)
+{
+    LOG4CXX_TRACE(amisBmkWriterLog, "Writing bookmarks to " << filepath);
+
+    if (not createDocument(pFile))
+        return false;
+
+    return writeDocument(filepath);
+}
+
+/**
+ * Build the xml document for a bookmark file in memory
+ *
+ * The bookmark file is only read here, so a caller sharing it with other
+ * threads only needs to lock it for this step and not for writeDocument.
+ *
+ * @param pFile The bookmark file
+ * @return Returns true on success
+ */
+bool amis::BookmarksWriter::createDocument(BookmarkFile* pFile)
 {
     mpFile = pFile;
     unsigned int i;
 
-    LOG4CXX_TRACE(amisBmkWriterLog, "Writing bookmarks to " << filepath);
+    if (mpDoc != NULL)
+    {
+        xmlFreeDoc(mpDoc);
+        mpDoc = NULL;
+    }
 
     xmlDocPtr doc;
 
@@ -124,6 +152,20 @@ bool amis::BookmarksWriter::saveFile(string filepath, BookmarkFile* pFile)
     if (rc < 0)
         return rc;
 
+    //tells which journal records are already part of this file
+    if (mpFile->getJournalGeneration() > 0)
+    {
+        rc = xmlTextWriterWriteFormatAttribute(xmlwriter, X("journal"), "%d",
+                mpFile->getJournalGeneration());
+        if (rc < 0)
+        {
+            LOG4CXX_ERROR(amisBmkWriterLog, "Error at xmlTextWriterWriteFormatAttribute");
+            xmlFreeTextWriter(xmlwriter);
+            xmlFreeDoc(doc);
+            return false;
+        }
+    }
+
     //start adding data
     rc = writeTitle(mpFile->getTitle());
     if (rc < 0)
@@ -207,9 +249,28 @@ bool amis::BookmarksWriter::saveFile(string filepath, BookmarkFile* pFile)
 
     xmlFreeTextWriter(xmlwriter);
 
-    //------------------
-    // save the document to a file
-    //------------------
+    mpDoc = doc;
+
+    return true;
+}
+
+/**
+ * Write the document built by createDocument to a file
+ *
+ * The document is written to a temporary file next to the target, flushed
+ * to disk and renamed over the target, so the bookmark file is either the
+ * old or the new version even if the power is cut while writing.
+ *
+ * @param filepath Path of the bookmark file
+ * @return Returns true on success
+ */
+bool amis::BookmarksWriter::writeDocument(string filepath)
+{
+    if (mpDoc == NULL)
+    {
+        LOG4CXX_ERROR(amisBmkWriterLog, "No document to write");
+        return false;
+    }
 
     // make sure the path to the file exists
     string dir = amis::FilePathTools::getParentDirectory(filepath);
@@ -219,16 +280,33 @@ bool amis::BookmarksWriter::saveFile(string filepath, BookmarkFile* pFile)
     }
 
     // write the file
+    string tmp_path = filepath + ".tmp";
     LOG4CXX_DEBUG(amisBmkWriterLog, "writing file to " + filepath);
-    rc = xmlSaveFormatFileEnc(filepath.c_str(), doc, ENCODING, 1);
+    int rc = xmlSaveFormatFileEnc(tmp_path.c_str(), mpDoc, ENCODING, 1);
+
+    xmlFreeDoc(mpDoc);
+    mpDoc = NULL;
+
     if (rc < 0)
     {
         LOG4CXX_ERROR(amisBmkWriterLog, "Error at xmlSaveFormatFileEnc");
-        xmlFreeDoc(doc);
+        remove(tmp_path.c_str());
         return false;
     }
 
-    xmlFreeDoc(doc);
+    int fd = open(tmp_path.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        fsync(fd);
+        close(fd);
+    }
+
+    if (rename(tmp_path.c_str(), filepath.c_str()) != 0)
+    {
+        LOG4CXX_ERROR(amisBmkWriterLog, "Error renaming " << tmp_path);
+        remove(tmp_path.c_str());
+        return false;
+    }
 
     return true;
 }
@@ -42,6 +42,8 @@ public:
     ~BookmarksWriter();
 
     bool saveFile(std::string, BookmarkFile*);
+    bool createDocument(BookmarkFile*);
+    bool writeDocument(std::string);
 
 private:
     int writeTitle(amis::MediaGroup*);
@@ -54,6 +56,7 @@ private:
     int writeNote(amis::MediaGroup*);
 
     xmlTextWriterPtr xmlwriter;
+    xmlDocPtr mpDoc;
     BookmarkFile* mpFile;
 };
 
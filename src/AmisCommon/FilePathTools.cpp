@@ -127,7 +127,7 @@ string amis::FilePathTools::getAsLocalFilePath(const string filepath)
     //general idea .. strip off any xyz:// and convert the remainder to backslashes
     //also remove the target if exists
 
-    static string file_path;
+    string file_path;
     string::size_type pos;
 
     file_path = convertSlashesFwd(filepath);
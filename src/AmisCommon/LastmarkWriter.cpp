@@ -0,0 +1,515 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "LastmarkWriter.h"
+#include "BookmarksWriter.h"
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <log4cxx/logger.h>
+
+// create logger which will become a child to logger kolibre.amis
+log4cxx::LoggerPtr amisLastmarkWriterLog(
+        log4cxx::Logger::getLogger("kolibre.amis.lastmarkwriter"));
+
+using namespace std;
+
+void *amis::lastmark_thread(void *lastmarkWriter)
+{
+    ((amis::LastmarkWriter *) lastmarkWriter)->run();
+    return NULL;
+}
+
+amis::LastmarkWriter::LastmarkWriter()
+{
+    mpFile = NULL;
+    //lose at most a few seconds of position if the power is cut
+    mFlushInterval = 5000;
+    mNumWrites = 0;
+    mbDirty = false;
+    mbStop = false;
+    mbJournal = false;
+    mJournalLimit = 500;
+    mbSnapshotDue = false;
+    mbThreadActive = false;
+    pthread_mutex_init(&mFileMutex, NULL);
+    pthread_mutex_init(&mWriteMutex, NULL);
+    pthread_cond_init(&mCond, NULL);
+}
+
+amis::LastmarkWriter::~LastmarkWriter()
+{
+    stop();
+    pthread_cond_destroy(&mCond);
+    pthread_mutex_destroy(&mWriteMutex);
+    pthread_mutex_destroy(&mFileMutex);
+}
+
+/**
+ * Attach a bookmark file and start the writer thread
+ *
+ * @param filePath Where the bookmark file is saved
+ * @param pFile The bookmark file, owned by the caller
+ */
+void amis::LastmarkWriter::start(string filePath, BookmarkFile* pFile)
+{
+    stop();
+
+    pthread_mutex_lock(&mWriteMutex);
+    pthread_mutex_lock(&mFileMutex);
+    mFilePath = filePath;
+    mpFile = pFile;
+    mbDirty = false;
+    mbSnapshotDue = false;
+    pthread_mutex_unlock(&mFileMutex);
+
+    //bring the file up to date with the journal of the last session
+    string journal_path = BookmarksJournal::getJournalPath(filePath);
+    if (mbJournal || access(journal_path.c_str(), F_OK) == 0)
+    {
+        if (mJournal.open(filePath, pFile).getCode() != amis::OK)
+            LOG4CXX_WARN(amisLastmarkWriterLog,
+                    "Bookmarks journal not available, writing whole files");
+
+        if (mbJournal == false)
+        {
+            if (mJournal.getNumberOfRecords() == 0 || writeSnapshot())
+                mJournal.remove();
+            else
+                mJournal.close();
+        }
+        //a journal never continues a file written without journal
+        else if (mJournal.isOpen() && (pFile->getJournalGeneration() == 0
+                || mJournal.getNumberOfRecords() >= mJournalLimit))
+        {
+            writeSnapshot();
+        }
+    }
+    pthread_mutex_unlock(&mWriteMutex);
+
+    pthread_mutex_lock(&mFileMutex);
+    mbStop = false;
+    if (pthread_create(&mThread, NULL, lastmark_thread, this) == 0)
+    {
+        mbThreadActive = true;
+    }
+    else
+    {
+        LOG4CXX_WARN(amisLastmarkWriterLog,
+                "Failed to start lastmark thread, saving on close only");
+    }
+    pthread_mutex_unlock(&mFileMutex);
+}
+
+/**
+ * Stop the writer thread, save a pending lastmark and detach the bookmark
+ * file. Must be called before the bookmark file is deleted.
+ */
+void amis::LastmarkWriter::stop()
+{
+    pthread_mutex_lock(&mFileMutex);
+    mbStop = true;
+    bool b_join = mbThreadActive;
+    mbThreadActive = false;
+    pthread_cond_broadcast(&mCond);
+    pthread_mutex_unlock(&mFileMutex);
+
+    if (b_join)
+        pthread_join(mThread, NULL);
+
+    flush();
+
+    //leave a complete bookmark file behind
+    pthread_mutex_lock(&mWriteMutex);
+    if (mJournal.isOpen())
+    {
+        if (mJournal.getNumberOfRecords() > 0)
+            writeSnapshot();
+        mJournal.close();
+    }
+
+    pthread_mutex_lock(&mFileMutex);
+    mpFile = NULL;
+    pthread_mutex_unlock(&mFileMutex);
+    pthread_mutex_unlock(&mWriteMutex);
+}
+
+/**
+ * Lock the bookmark file before changing it
+ */
+void amis::LastmarkWriter::lock()
+{
+    pthread_mutex_lock(&mFileMutex);
+}
+
+/**
+ * Unlock the bookmark file
+ */
+void amis::LastmarkWriter::unlock()
+{
+    pthread_mutex_unlock(&mFileMutex);
+}
+
+/**
+ * Replace the lastmark and schedule a write, returns without touching disk
+ *
+ * @param pPos The new lastmark, owned by the bookmark file from now on
+ */
+void amis::LastmarkWriter::setLastmark(PositionData* pPos)
+{
+    pthread_mutex_lock(&mFileMutex);
+
+    if (mpFile == NULL)
+    {
+        pthread_mutex_unlock(&mFileMutex);
+        delete pPos;
+        return;
+    }
+
+    mpFile->setLastmark(pPos);
+
+    if (mbDirty == false)
+    {
+        mbDirty = true;
+        pthread_cond_broadcast(&mCond);
+    }
+
+    pthread_mutex_unlock(&mFileMutex);
+}
+
+/**
+ * Add a bookmark to the file and save it
+ *
+ * @param pBookmark The bookmark, owned by the bookmark file from now on
+ * @return Returns true if the change was saved
+ */
+bool amis::LastmarkWriter::addBookmark(Bookmark* pBookmark)
+{
+    pthread_mutex_lock(&mWriteMutex);
+    pthread_mutex_lock(&mFileMutex);
+
+    if (mpFile == NULL)
+    {
+        pthread_mutex_unlock(&mFileMutex);
+        pthread_mutex_unlock(&mWriteMutex);
+        return false;
+    }
+
+    mpFile->addBookmark(pBookmark);
+    string record = mJournal.bookmarkRecord(pBookmark);
+    pthread_mutex_unlock(&mFileMutex);
+
+    bool b_ok = store(record);
+    pthread_mutex_unlock(&mWriteMutex);
+    return b_ok;
+}
+
+/**
+ * Delete a bookmark or hilite from the file and save it
+ *
+ * @param idx Index of the item
+ * @return Returns true if the change was saved
+ */
+bool amis::LastmarkWriter::deleteItem(int idx)
+{
+    pthread_mutex_lock(&mWriteMutex);
+    pthread_mutex_lock(&mFileMutex);
+
+    if (mpFile == NULL || idx < 0 || idx >= mpFile->getNumberOfItems())
+    {
+        pthread_mutex_unlock(&mFileMutex);
+        pthread_mutex_unlock(&mWriteMutex);
+        return false;
+    }
+
+    mpFile->deleteItem(idx);
+    string record = mJournal.deleteRecord(idx);
+    pthread_mutex_unlock(&mFileMutex);
+
+    bool b_ok = store(record);
+    pthread_mutex_unlock(&mWriteMutex);
+    return b_ok;
+}
+
+/**
+ * Delete all bookmarks and hilites from the file and save it
+ *
+ * @return Returns true if the change was saved
+ */
+bool amis::LastmarkWriter::deleteAllItems()
+{
+    pthread_mutex_lock(&mWriteMutex);
+    pthread_mutex_lock(&mFileMutex);
+
+    if (mpFile == NULL)
+    {
+        pthread_mutex_unlock(&mFileMutex);
+        pthread_mutex_unlock(&mWriteMutex);
+        return false;
+    }
+
+    while (mpFile->getNumberOfItems() > 0)
+        mpFile->deleteItem(mpFile->getNumberOfItems() - 1);
+    string record = mJournal.deleteAllRecord();
+    pthread_mutex_unlock(&mFileMutex);
+
+    bool b_ok = store(record);
+    pthread_mutex_unlock(&mWriteMutex);
+    return b_ok;
+}
+
+/**
+ * Write the whole bookmark file now, after changes made between lock() and
+ * unlock()
+ *
+ * @return Returns true if the file was written
+ */
+bool amis::LastmarkWriter::save()
+{
+    pthread_mutex_lock(&mWriteMutex);
+    bool b_ok = writeSnapshot();
+    pthread_mutex_unlock(&mWriteMutex);
+    return b_ok;
+}
+
+/**
+ * Save the bookmark file now if a lastmark is waiting to be written
+ *
+ * @return Returns false if the file could not be written
+ */
+bool amis::LastmarkWriter::flush()
+{
+    pthread_mutex_lock(&mFileMutex);
+    bool b_dirty = mbDirty;
+    pthread_mutex_unlock(&mFileMutex);
+
+    if (b_dirty == false)
+        return true;
+
+    return write();
+}
+
+/**
+ * Set the time from the first unsaved lastmark until it is written
+ *
+ * @param interval Milliseconds
+ */
+void amis::LastmarkWriter::setFlushInterval(unsigned int interval)
+{
+    pthread_mutex_lock(&mFileMutex);
+    mFlushInterval = interval;
+    pthread_cond_broadcast(&mCond);
+    pthread_mutex_unlock(&mFileMutex);
+}
+
+unsigned int amis::LastmarkWriter::getFlushInterval()
+{
+    return mFlushInterval;
+}
+
+/**
+ * Append changes to a journal instead of writing the whole file, takes
+ * effect on the next start()
+ */
+void amis::LastmarkWriter::setJournal(bool journal)
+{
+    mbJournal = journal;
+}
+
+bool amis::LastmarkWriter::getJournal()
+{
+    return mbJournal;
+}
+
+/**
+ * Set the number of journal records after which the whole file is written
+ */
+void amis::LastmarkWriter::setJournalLimit(unsigned int limit)
+{
+    mJournalLimit = limit > 0 ? limit : 1;
+}
+
+/**
+ * Get the number of times the bookmark file has been written
+ */
+unsigned long amis::LastmarkWriter::getNumberOfWrites()
+{
+    pthread_mutex_lock(&mFileMutex);
+    unsigned long value = mNumWrites;
+    pthread_mutex_unlock(&mFileMutex);
+    return value;
+}
+
+/**
+ * Wait for lastmarks and write them when the flush interval has passed
+ */
+void amis::LastmarkWriter::run()
+{
+    pthread_mutex_lock(&mFileMutex);
+
+    while (mbStop == false)
+    {
+        while (mbDirty == false && mbStop == false)
+        {
+            pthread_cond_wait(&mCond, &mFileMutex);
+        }
+
+        //let more lastmarks arrive before writing
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += mFlushInterval / 1000;
+        deadline.tv_nsec += (mFlushInterval % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        while (mbDirty == true && mbStop == false)
+        {
+            if (pthread_cond_timedwait(&mCond, &mFileMutex, &deadline)
+                    == ETIMEDOUT)
+                break;
+        }
+
+        //a stop writes the lastmark itself, a save may have written it
+        if (mbStop == true || mbDirty == false)
+            continue;
+
+        pthread_mutex_unlock(&mFileMutex);
+        write();
+        pthread_mutex_lock(&mFileMutex);
+    }
+
+    pthread_mutex_unlock(&mFileMutex);
+}
+
+/**
+ * Save the lastmark, as a journal record if the journal is open
+ */
+bool amis::LastmarkWriter::write()
+{
+    pthread_mutex_lock(&mWriteMutex);
+
+    if (mJournal.isOpen() == false || mbSnapshotDue == true)
+    {
+        bool b_ok = writeSnapshot();
+        pthread_mutex_unlock(&mWriteMutex);
+        return b_ok;
+    }
+
+    pthread_mutex_lock(&mFileMutex);
+    if (mpFile == NULL)
+    {
+        pthread_mutex_unlock(&mFileMutex);
+        pthread_mutex_unlock(&mWriteMutex);
+        return false;
+    }
+
+    string record;
+    if (mpFile->getLastmark() != NULL)
+        record = mJournal.lastmarkRecord(mpFile->getLastmark());
+    mbDirty = false;
+    pthread_mutex_unlock(&mFileMutex);
+
+    bool b_ok = record.empty() || store(record);
+    pthread_mutex_unlock(&mWriteMutex);
+
+    return b_ok;
+}
+
+/**
+ * Save a change with mWriteMutex held, as a journal record if the journal is
+ * open and by writing the whole file otherwise
+ *
+ * @param record The journal record for the change
+ */
+bool amis::LastmarkWriter::store(const string& record)
+{
+    if (mJournal.isOpen() == false || mbSnapshotDue == true
+            || mJournal.append(record) == false)
+        return writeSnapshot();
+
+    pthread_mutex_lock(&mFileMutex);
+    mNumWrites++;
+    pthread_mutex_unlock(&mFileMutex);
+
+    if (mJournal.getNumberOfRecords() >= mJournalLimit)
+        writeSnapshot();
+
+    return true;
+}
+
+/**
+ * Write the whole bookmark file with mWriteMutex held and start a new journal.
+ * The document is built with the bookmark file locked and written unlocked.
+ */
+bool amis::LastmarkWriter::writeSnapshot()
+{
+    pthread_mutex_lock(&mFileMutex);
+    if (mpFile == NULL)
+    {
+        pthread_mutex_unlock(&mFileMutex);
+        return false;
+    }
+
+    //the new file includes every record of the current journal
+    int generation = mpFile->getJournalGeneration();
+    if (mJournal.isOpen())
+    {
+        generation++;
+        mpFile->setJournalGeneration(generation);
+    }
+
+    BookmarksWriter writer;
+    string file_path = mFilePath;
+    bool b_ok = writer.createDocument(mpFile);
+    mbDirty = false;
+    pthread_mutex_unlock(&mFileMutex);
+
+    if (b_ok)
+        b_ok = writer.writeDocument(file_path);
+
+    if (b_ok && mJournal.isOpen() && mJournal.reset(generation) == false)
+    {
+        LOG4CXX_WARN(amisLastmarkWriterLog,
+                "Bookmarks journal not available, writing whole files");
+        mJournal.close();
+    }
+
+    pthread_mutex_lock(&mFileMutex);
+    if (b_ok)
+    {
+        mNumWrites++;
+        mbSnapshotDue = false;
+    }
+    else
+    {
+        LOG4CXX_WARN(amisLastmarkWriterLog,
+                "Failed to save bookmark file " << file_path);
+        //try again later
+        mbDirty = true;
+        mbSnapshotDue = true;
+    }
+    pthread_mutex_unlock(&mFileMutex);
+
+    return b_ok;
+}
@@ -0,0 +1,117 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef LASTMARKWRITER_H
+#define LASTMARKWRITER_H
+
+#include "AmisCommon.h"
+#include "Bookmarks.h"
+#include "BookmarksJournal.h"
+
+#include <string>
+#include <pthread.h>
+
+namespace amis
+{
+
+void *lastmark_thread(void *);
+
+//! The Lastmark Writer saves a bookmark file on a background thread
+/*!
+ Lastmark updates only change the bookmark file in memory and wake the
+ writer thread, which saves the file once the flush interval has passed
+ since the first unsaved update. Updates arriving meanwhile are written
+ together, the latest lastmark wins.
+
+ The bookmark file is shared with the writer thread while it is attached.
+ Bookmarks are added and deleted through the writer, other changes must be
+ made between lock() and unlock(). The lock is only held while a change is
+ made or the xml document is built, never while writing to disk.
+
+ With the journal enabled each change is appended to a BookmarksJournal and
+ the whole bookmark file is only written when the journal gets long, on
+ save() and when the writer is stopped. A journal left by an earlier session
+ is applied by start() whether the journal is enabled or not.
+ */
+class AMISCOMMON_API LastmarkWriter
+{
+
+public:
+    LastmarkWriter();
+    ~LastmarkWriter();
+
+    void start(std::string, BookmarkFile*);
+    void stop();
+
+    void lock();
+    void unlock();
+
+    void setLastmark(PositionData*);
+    bool addBookmark(Bookmark*);
+    bool deleteItem(int);
+    bool deleteAllItems();
+    bool save();
+    bool flush();
+
+    void setFlushInterval(unsigned int);
+    unsigned int getFlushInterval();
+    void setJournal(bool);
+    bool getJournal();
+    void setJournalLimit(unsigned int);
+    unsigned long getNumberOfWrites();
+
+private:
+    void run();
+    bool write();
+    bool store(const std::string&);
+    bool writeSnapshot();
+
+    std::string mFilePath;
+    BookmarkFile* mpFile;
+    BookmarksJournal mJournal;
+
+    //!milliseconds between the first unsaved lastmark and the write
+    unsigned int mFlushInterval;
+    unsigned long mNumWrites;
+    bool mbDirty;
+    bool mbStop;
+
+    //!append changes to a journal instead of writing the whole file
+    bool mbJournal;
+    //!journal records before the whole file is written
+    unsigned int mJournalLimit;
+    //!the journal misses a change, write the whole file next time
+    bool mbSnapshotDue;
+
+    pthread_t mThread;
+    bool mbThreadActive;
+    //!protects the bookmark file and the flags
+    pthread_mutex_t mFileMutex;
+    //!lets one thread at a time write to disk, taken before mFileMutex
+    pthread_mutex_t mWriteMutex;
+    //!signals new lastmarks and stop requests
+    pthread_cond_t mCond;
+
+    friend void *lastmark_thread(void *);
+};
+
+}
+
+#endif
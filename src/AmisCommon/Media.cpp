@@ -22,6 +22,13 @@
 
 //Amis media objects implementation
 #include "Media.h"
+#include "StringPool.h"
+#include <cstring>
+#include <climits>
+
+//!largest value of one clock value field, far longer than any book
+#define CLOCK_FIELD_MAX 999999999LL
+
 using namespace std;
 
 /*
@@ -31,27 +38,24 @@ using namespace std;
 //--------------------------------------------------
 amis::MediaNode::MediaNode()
 {
+    const std::string* p_empty = StringPool::Instance()->getEmpty();
+
     mId = "";
-    mClass = "";
-    mSrc = "";
-    mSourceModule = "";
-    mRegionId = "";
+    mpClass = p_empty;
+    mpSrc = p_empty;
+    mpSourceModule = p_empty;
+    mpRegionId = p_empty;
     mHref = "";
-    mMediaType = "";
+    mpMediaType = p_empty;
+    mpLangCode = p_empty;
+    //the subclass constructors set their own type
+    mMediaNodeType = amis::AUDIO;
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
 amis::MediaNode::~MediaNode()
 {
-    mId = "";
-    mClass = "";
-    mSrc = "";
-    mSourceModule = "";
-    mRegionId = "";
-    mHref = "";
-    mMediaType = "";
-
 }
 
 //--------------------------------------------------
@@ -65,28 +69,28 @@ void amis::MediaNode::setId(std::string id)
 //--------------------------------------------------
 void amis::MediaNode::setClass(std::string className)
 {
-    mClass = className;
+    mpClass = StringPool::Instance()->intern(className);
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
 void amis::MediaNode::setSrc(std::string src)
 {
-    mSrc = src;
+    mpSrc = StringPool::Instance()->intern(src);
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
 void amis::MediaNode::setSourceModuleName(std::string sourceModuleName)
 {
-    mSourceModule = sourceModuleName;
+    mpSourceModule = StringPool::Instance()->intern(sourceModuleName);
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
 void amis::MediaNode::setRegionId(std::string regionId)
 {
-    mRegionId = regionId;
+    mpRegionId = StringPool::Instance()->intern(regionId);
 }
 
 //--------------------------------------------------
@@ -100,70 +104,70 @@ void amis::MediaNode::setHref(std::string href)
 //--------------------------------------------------
 void amis::MediaNode::setMediaType(std::string type)
 {
-    mMediaType = type;
+    mpMediaType = StringPool::Instance()->intern(type);
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
 void amis::MediaNode::setLangCode(std::string langcode)
 {
-    mLangCode = langcode;
+    mpLangCode = StringPool::Instance()->intern(langcode);
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
-std::string amis::MediaNode::getId()
+const std::string& amis::MediaNode::getId()
 {
     return mId;
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
-std::string amis::MediaNode::getClass()
+const std::string& amis::MediaNode::getClass()
 {
-    return mClass;
+    return *mpClass;
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
-std::string amis::MediaNode::getSrc()
+const std::string& amis::MediaNode::getSrc()
 {
-    return mSrc;
+    return *mpSrc;
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
-std::string amis::MediaNode::getSourceModuleName()
+const std::string& amis::MediaNode::getSourceModuleName()
 {
-    return mSourceModule;
+    return *mpSourceModule;
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
-std::string amis::MediaNode::getRegionId()
+const std::string& amis::MediaNode::getRegionId()
 {
-    return mRegionId;
+    return *mpRegionId;
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
-std::string amis::MediaNode::getHref()
+const std::string& amis::MediaNode::getHref()
 {
     return mHref;
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
-std::string amis::MediaNode::getMediaType()
+const std::string& amis::MediaNode::getMediaType()
 {
-    return mMediaType;
+    return *mpMediaType;
 }
 
 //--------------------------------------------------
 //--------------------------------------------------
-std::string amis::MediaNode::getLangCode()
+const std::string& amis::MediaNode::getLangCode()
 {
-    return mLangCode;
+    return *mpLangCode;
 }
 
 amis::MediaNodeType amis::MediaNode::getMediaNodeType()
@@ -195,6 +199,15 @@ amis::TextNode::~TextNode()
     mText.erase();
 }
 
+//--------------------------------------------------
+//--------------------------------------------------
+void amis::TextNode::setSrc(std::string src)
+{
+    //text srcs point at single elements and are nearly all unique,
+    //pooling them would keep every one for the life of the process
+    mSrc = src;
+}
+
 //--------------------------------------------------
 //--------------------------------------------------
 void amis::TextNode::setTextString(std::string text)
@@ -216,6 +229,13 @@ void amis::TextNode::setLangDir(TextDirection direction)
     }
 }
 
+//--------------------------------------------------
+//--------------------------------------------------
+const std::string& amis::TextNode::getSrc()
+{
+    return mSrc;
+}
+
 //--------------------------------------------------
 //--------------------------------------------------
 std::string amis::TextNode::getTextString()
@@ -240,6 +260,8 @@ amis::AudioNode::AudioNode()
     setMediaNodeType(amis::AUDIO);
     mClipBegin = "";
     mClipEnd = "";
+    mClipBeginMs = -1;
+    mClipEndMs = -1;
 }
 
 //--------------------------------------------------
@@ -255,6 +277,7 @@ amis::AudioNode::~AudioNode()
 void amis::AudioNode::setClipBegin(const std::string clipBegin)
 {
     mClipBegin = clipBegin;
+    mClipBeginMs = clockValueToMs(clipBegin);
 }
 
 //--------------------------------------------------
@@ -262,6 +285,7 @@ void amis::AudioNode::setClipBegin(const std::string clipBegin)
 void amis::AudioNode::setClipEnd(const std::string clipEnd)
 {
     mClipEnd = clipEnd;
+    mClipEndMs = clockValueToMs(clipEnd);
 }
 
 //--------------------------------------------------
@@ -277,21 +301,157 @@ const std::string amis::AudioNode::getClipEnd()
 {
     return mClipEnd;
 }
-amis::AudioNode* amis::AudioNode::copySelf()
+
+//--------------------------------------------------
+//--------------------------------------------------
+long amis::AudioNode::getClipBeginMs()
 {
-    amis::AudioNode* p_new = new amis::AudioNode();
+    return mClipBeginMs;
+}
+
+//--------------------------------------------------
+//--------------------------------------------------
+long amis::AudioNode::getClipEndMs()
+{
+    return mClipEndMs;
+}
+
+//--------------------------------------------------
+// "npt=0:01:02.5" -> 62500
+// "00:02.5" -> 2500
+// "12.345s", "1.5min", "250ms" -> 12345, 90000, 250
+// "smpte-25=00:00:01:05" -> 1200
+// returns -1 if the value could not be parsed
+//--------------------------------------------------
+long amis::AudioNode::clockValueToMs(const std::string& value)
+{
+    const char* p_str = value.c_str();
+    while (*p_str == ' ')
+        p_str++;
+
+    //smil 1.0 clip values name their format, smil 2.0 ones are clock values
+    int fps = 0;
+    if (strncmp(p_str, "npt=", 4) == 0)
+    {
+        p_str += 4;
+    }
+    else if (strncmp(p_str, "smpte=", 6) == 0)
+    {
+        fps = 30;
+        p_str += 6;
+    }
+    else if (strncmp(p_str, "smpte-30-drop=", 14) == 0)
+    {
+        //drop frame time codes follow the clock closely enough for audio
+        fps = 30;
+        p_str += 14;
+    }
+    else if (strncmp(p_str, "smpte-25=", 9) == 0)
+    {
+        fps = 25;
+        p_str += 9;
+    }
 
-    p_new->setClass(this->getClass());
-    p_new->setClipBegin(this->getClipBegin());
-    p_new->setClipEnd(this->getClipEnd());
-    p_new->setHref(this->getHref());
-    p_new->setId(this->getId());
-    p_new->setLangCode(this->getLangCode());
-    p_new->setMediaNodeType(this->getMediaNodeType());
-    p_new->setMediaType(this->getMediaType());
-    p_new->setRegionId(this->getRegionId());
-    p_new->setSourceModuleName(this->getSourceModuleName());
-    p_new->setSrc(this->getSrc());
+    //up to four colon separated fields, the frames of smpte values are last
+    //fields are capped so the sums below can not overflow
+    long long fields[4];
+    int num_fields = 0;
+    while (num_fields < 4)
+    {
+        if (*p_str < '0' || *p_str > '9')
+            return -1;
+        long long num = 0;
+        while (*p_str >= '0' && *p_str <= '9')
+        {
+            num = num * 10 + (*p_str - '0');
+            if (num > CLOCK_FIELD_MAX)
+                return -1;
+            p_str++;
+        }
+        fields[num_fields++] = num;
+
+        if (*p_str != ':')
+            break;
+        p_str++;
+    }
+
+    //the fraction is kept to microseconds
+    long long frac = 0;
+    long long frac_scale = 1;
+    if (*p_str == '.')
+    {
+        p_str++;
+        if (*p_str < '0' || *p_str > '9')
+            return -1;
+        while (*p_str >= '0' && *p_str <= '9')
+        {
+            if (frac_scale < 1000000)
+            {
+                frac = frac * 10 + (*p_str - '0');
+                frac_scale *= 10;
+            }
+            p_str++;
+        }
+    }
+
+    //a timecount may carry a unit, seconds by default
+    long long unit = 1000;
+    if (fps == 0 && num_fields == 1)
+    {
+        if (strncmp(p_str, "ms", 2) == 0)
+        {
+            unit = 1;
+            p_str += 2;
+        }
+        else if (strncmp(p_str, "min", 3) == 0)
+        {
+            unit = 60000;
+            p_str += 3;
+        }
+        else if (*p_str == 'h')
+        {
+            unit = 3600000;
+            p_str++;
+        }
+        else if (*p_str == 's')
+        {
+            p_str++;
+        }
+    }
+
+    while (*p_str == ' ')
+        p_str++;
+    if (*p_str != '\0')
+        return -1;
+
+    long long ms = 0;
+    if (fps > 0)
+    {
+        //hh:mm:ss:ff, the subframes after the frames are ignored
+        if (num_fields != 4)
+            return -1;
+        ms = ((fields[0] * 60LL + fields[1]) * 60 + fields[2]) * 1000
+                + fields[3] * 1000LL / fps;
+    }
+    else
+    {
+        if (num_fields > 3)
+            return -1;
+        long long whole = 0;
+        for (int i = 0; i < num_fields; i++)
+            whole = whole * 60 + fields[i];
+        ms = whole * unit + (frac * unit + frac_scale / 2) / frac_scale;
+    }
+
+    if (ms > LONG_MAX)
+        return -1;
+
+    return (long) ms;
+}
+amis::AudioNode* amis::AudioNode::copySelf()
+{
+    //the pooled strings and parsed clip times are shared with the copy
+    amis::AudioNode* p_new = new amis::AudioNode(*this);
 
     return p_new;
 }
@@ -373,6 +533,21 @@ void amis::MediaGroup::destroyContents()
 
 }
 
+//--------------------------------------------------
+/*!
+ the nodes are not deleted, they belong to whoever added them.  the memory
+ of the audio list and id is kept, so a cleared group can be filled again
+ without allocating
+ */
+//--------------------------------------------------
+void amis::MediaGroup::clear()
+{
+    mpTextNode = NULL;
+    mpImageNode = NULL;
+    mpAudioNodes.clear();
+    mId.clear();
+}
+
 //--------------------------------------------------
 //--------------------------------------------------
 void amis::MediaGroup::setText(TextNode* pTextNode)
@@ -474,7 +649,7 @@ unsigned int amis::MediaGroup::getNumberOfAudioClips()
     return mpAudioNodes.size();
 }
 
-void amis::MediaGroup::setId(std::string id)
+void amis::MediaGroup::setId(const std::string& id)
 {
     mId = id;
 }
@@ -31,6 +31,10 @@ namespace amis
 {
 /**
  * @brief Media node is the base class for specific media objects
+ *
+ * @details
+ * The values that repeat on every node of a book are kept in the StringPool,
+ * the id and href are stored in the node.
  */
 class AMISCOMMON_API MediaNode //amis::MediaNode
 {
@@ -45,7 +49,7 @@ public:
     //!set the class name
     void setClass(std::string className);
     //!set the src
-    void setSrc(std::string src);
+    virtual void setSrc(std::string src);
     //!set the language code
     void setLangCode(std::string langCode);
     //!set the source module name
@@ -60,44 +64,44 @@ public:
     void setMediaNodeType(amis::MediaNodeType);
 
     //!get the id
-    std::string getId();
+    const std::string& getId();
     //!get the class name
-    std::string getClass();
+    const std::string& getClass();
     //!get the src
-    std::string getSrc();
+    virtual const std::string& getSrc();
     //!get the language code
-    std::string getLangCode();
+    const std::string& getLangCode();
     //!get the source module name
-    std::string getSourceModuleName();
+    const std::string& getSourceModuleName();
     //!get the region id
-    std::string getRegionId();
+    const std::string& getRegionId();
     //!get the href
-    std::string getHref();
+    const std::string& getHref();
     //!get the media type
-    std::string getMediaType();
+    const std::string& getMediaType();
     //!get the media node type (amis-specific property)
     amis::MediaNodeType getMediaNodeType();
 
 private:
     //!the id
     std::string mId;
-    //!the class name
-    std::string mClass;
-    //!the src
-    std::string mSrc;
-    //!the source module name (where this node came from)
-    std::string mSourceModule;
-    //!the region id
+    //!the class name, pooled
+    const std::string* mpClass;
+    //!the src, pooled
+    const std::string* mpSrc;
+    //!the source module name (where this node came from), pooled
+    const std::string* mpSourceModule;
+    //!the region id, pooled
     /*!
      @todo: move this to SmilMediaGroup in the smil engine?
      */
-    std::string mRegionId;
+    const std::string* mpRegionId;
     //!the href
     std::string mHref;
-    //!the media tpe
-    std::string mMediaType;
-    //!the language code
-    std::string mLangCode;
+    //!the media tpe, pooled
+    const std::string* mpMediaType;
+    //!the language code, pooled
+    const std::string* mpLangCode;
     MediaNodeType mMediaNodeType;
 
 };
@@ -117,17 +121,23 @@ public:
     //!destructor
     ~TextNode();
 
+    //!set the src, text srcs are not pooled
+    void setSrc(std::string src);
     //!set the text string
     void setTextString(std::string text);
     //!set the language direction
     void setLangDir(TextDirection direction);
 
+    //!get the src
+    const std::string& getSrc();
     //!get the text string
     std::string getTextString();
     //!get the language direction
     TextDirection getLangDir();
 
 private:
+    //!the src, an href to a single element
+    std::string mSrc;
     //!the raw text string
     std::string mText;
     //!the language direction
@@ -155,6 +165,14 @@ public:
     //!get clip end time
     const std::string getClipEnd();
 
+    //!get clip begin time in milliseconds, -1 if it is missing or invalid
+    long getClipBeginMs();
+    //!get clip end time in milliseconds, -1 if it is missing or invalid
+    long getClipEndMs();
+
+    //!convert a smil clock value to milliseconds, -1 if it is not one
+    static long clockValueToMs(const std::string&);
+
     //@todo: eventually put this on all MediaNode-derived objects
     AudioNode* copySelf();
 
@@ -163,6 +181,10 @@ private:
     std::string mClipBegin;
     //!clip end
     std::string mClipEnd;
+    //!clip begin parsed when it is set
+    long mClipBeginMs;
+    //!clip end parsed when it is set
+    long mClipEndMs;
 };
 
 //!Image node is a type of MediaNode
@@ -193,6 +215,8 @@ public:
 
     //!destroy the node data pointed to by this media group
     void destroyContents();
+    //!forget the node pointers and id without deleting the nodes
+    void clear();
 
     //!set the text node pointer
     void setText(TextNode* pTextNode);
@@ -222,7 +246,7 @@ public:
     std::string getId();
 
     //!set the id of this media group
-    void setId(std::string);
+    void setId(const std::string&);
 
 private:
     //!the text node pointer
@@ -129,3 +129,15 @@ string Metadata::getChecksum()
 
     return checksum;
 }
+
+//--------------------------------------------------
+//--------------------------------------------------
+string Metadata::getContentChecksum()
+{
+    string checksum;
+
+    if (mbBookIsOpen == true)
+        checksum = mDataSet->getContentChecksum();
+
+    return checksum;
+}
@@ -55,6 +55,8 @@ public:
 
     //!get the checksum
     std::string getChecksum();
+    //!get the checksum of the book file bytes
+    std::string getContentChecksum();
 
 private:
     //!metadata set
@@ -53,6 +53,7 @@ amis::MetadataSet::MetadataSet()
 {
     clearVector();
     b_getChars = false;
+    mNumHashed = 0;
     mError.setSourceModuleName(amis::module_AmisCommon);
 }
 
@@ -105,21 +106,16 @@ string amis::MetadataSet::getMetadata(string metaname)
     return null_str;
 }
 
+//--------------------------------------------------
+//! the checksum covers "name=content\n" for each metaitem in document order
+//--------------------------------------------------
 string amis::MetadataSet::getChecksum()
 {
-    unsigned int i;
-    string content;
-
-    for (i = 0; i < mMetaList.size(); i++)
-    {
-        content.append(mMetaList[i]->mName);
-        content.append("=");
-        content.append(mMetaList[i]->mContent);
-        content.append("\n");
-    }
+    hashItems();
 
-    // Create an md5 checksum digest
-    string hash = md5(content);
+    // Finish a copy, the parse may still add items
+    MD5 hasher = mHasher;
+    string hash = hasher.finalize().hexdigest();
 
     LOG4CXX_INFO(amisMetadataSetLog,
             "Generated md5 of metadata " << hash);
@@ -127,6 +123,39 @@ string amis::MetadataSet::getChecksum()
     return hash;
 }
 
+//--------------------------------------------------
+/*!
+ Checksum of the NCC or OPF file itself. Unlike getChecksum it changes with
+ any edit of the file, and it is cheaper since the file is not parsed.
+ */
+//--------------------------------------------------
+string amis::MetadataSet::getContentChecksum()
+{
+    string hash = md5file(mFilepath);
+
+    LOG4CXX_INFO(amisMetadataSetLog,
+            "Generated md5 of " << mFilepath << " " << hash);
+
+    return hash;
+}
+
+//--------------------------------------------------
+/*!
+ An item is complete once the next element starts, until then character
+ data may still set its content.
+ */
+//--------------------------------------------------
+void amis::MetadataSet::hashItems()
+{
+    for (; mNumHashed < mMetaList.size(); mNumHashed++)
+    {
+        mHasher.update(mMetaList[mNumHashed]->mName);
+        mHasher.update("=", 1);
+        mHasher.update(mMetaList[mNumHashed]->mContent);
+        mHasher.update("\n", 1);
+    }
+}
+
 //--------------------------------------------------
 /*!
  @param[in] filepath
@@ -218,6 +247,9 @@ bool amis::MetadataSet::startElement(const xmlChar* const uri,
     string sub_string;
     MetaItem* meta_item = NULL;
 
+    //the previous metaitem is complete
+    hashItems();
+
     //get the element name as a string
     element_name = XmlReader::transcode(qname);
 
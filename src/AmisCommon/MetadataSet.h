@@ -30,6 +30,7 @@
 //PROJECT INCLUDES
 #include "AmisCommon.h"
 #include "AmisError.h"
+#include "md5.h"
 
 #include <XmlDefaultHandler.h>
 #include <XmlAttributes.h>
@@ -72,6 +73,8 @@ public:
 
     //!retrieve an md5 checksum of all the metadata content
     std::string getChecksum();
+    //!retrieve an md5 checksum of the bytes of the book file
+    std::string getContentChecksum();
 
 //SAX METHODS
     //!xmlreader start element event
@@ -91,12 +94,18 @@ private:
     std::string mFilepath;
     //!clear the metaitem vector
     void clearVector();
+    //!feed the metaitems that can no longer change to the checksum
+    void hashItems();
     //!list of metaitems
     std::vector<amis::MetaItem*> mMetaList;
     //!flag if we are getting the chardata or not
     bool b_getChars;
     //!chardata accumulator
     std::string mTempChars;
+    //!checksum of the metaitems so far
+    MD5 mHasher;
+    //!number of metaitems fed to the checksum
+    unsigned int mNumHashed;
 
     AmisError mError;
 
@@ -0,0 +1,81 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "StringPool.h"
+
+using namespace std;
+
+/**
+ * Get the pool, it is created by the first call from any thread
+ */
+amis::StringPool* amis::StringPool::Instance()
+{
+    static StringPool instance;
+    return &instance;
+}
+
+amis::StringPool::StringPool()
+{
+    pthread_mutex_init(&mMutex, NULL);
+    mpEmpty = &*mStrings.insert(string()).first;
+}
+
+amis::StringPool::~StringPool()
+{
+    pthread_mutex_destroy(&mMutex);
+}
+
+/**
+ * Get the pooled copy of a string, adding it if it is new
+ *
+ * The elements of an unordered set stay in place when it grows, so the
+ * returned pointer is valid for the life of the process.
+ *
+ * @param str The string
+ * @return Returns the pooled copy
+ */
+const string* amis::StringPool::intern(const string& str)
+{
+    if (str.empty())
+        return mpEmpty;
+
+    pthread_mutex_lock(&mMutex);
+    const string* p_str = &*mStrings.insert(str).first;
+    pthread_mutex_unlock(&mMutex);
+
+    return p_str;
+}
+
+/**
+ * Get the pooled empty string without locking the pool
+ */
+const string* amis::StringPool::getEmpty()
+{
+    return mpEmpty;
+}
+
+unsigned int amis::StringPool::getNumberOfStrings()
+{
+    pthread_mutex_lock(&mMutex);
+    unsigned int size = mStrings.size();
+    pthread_mutex_unlock(&mMutex);
+
+    return size;
+}
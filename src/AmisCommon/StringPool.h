@@ -0,0 +1,68 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include "AmisCommon.h"
+
+#include <string>
+#include <tr1/unordered_set>
+#include <pthread.h>
+
+namespace amis
+{
+
+//! The String Pool keeps one copy of each string interned in it
+/*!
+ Media nodes intern the values that repeat on every node of a book, such as
+ the audio file name and the region id, and hold a pointer to the pooled
+ copy. Two interned strings are equal if and only if their pointers are.
+
+ Pooled strings live as long as the process. Media nodes are copied into
+ media groups and bookmarks that outlive the book they came from, so the
+ strings can not be freed when a book is closed. Only values taken from a
+ limited set, like file names, should be interned, never ids, hrefs or the
+ text srcs that point at single elements.
+
+ The pool may be used from several threads.
+ */
+class AMISCOMMON_API StringPool
+{
+
+public:
+    static StringPool* Instance();
+
+    const std::string* intern(const std::string&);
+    const std::string* getEmpty();
+
+    unsigned int getNumberOfStrings();
+
+private:
+    StringPool();
+    ~StringPool();
+
+    std::tr1::unordered_set<std::string> mStrings;
+    const std::string* mpEmpty;
+    pthread_mutex_t mMutex;
+};
+
+}
+#endif
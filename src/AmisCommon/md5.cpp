@@ -35,6 +35,12 @@ documentation and/or software.
 
 /* system implementation headers */
 #include <stdio.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
 
 
 // Constants for MD5Transform routine.
@@ -293,6 +299,14 @@ void MD5::update(const char input[], size_type length)
 
 //////////////////////////////
 
+// feed a string without the terminating null
+void MD5::update(const std::string& text)
+{
+  update(text.data(), text.length());
+}
+
+//////////////////////////////
+
 // MD5 finalization. Ends an MD5 message-digest operation, writing the
 // the message digest and zeroizing the context.
 MD5& MD5::finalize()
@@ -360,3 +374,67 @@ std::string md5(const std::string str)
 
     return md5.hexdigest();
 }
+
+//////////////////////////////
+
+// hash the bytes of a file, mapped into memory where possible so they are
+// not copied, returns an empty string if the file can't be read
+std::string md5file(const std::string path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return "";
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return "";
+    }
+
+    MD5 md5;
+    bool hashed = false;
+
+#ifndef WIN32
+    if (st.st_size > 0)
+    {
+        void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+            // feed it in pieces, update() takes a 32 bit length
+            const char* p = (const char*) data;
+            off_t remaining = st.st_size;
+            while (remaining > 0)
+            {
+                MD5::size_type length = remaining > (1 << 30) ? (1 << 30) : remaining;
+                md5.update(p, length);
+                p += length;
+                remaining -= length;
+            }
+
+            munmap(data, st.st_size);
+            hashed = true;
+        }
+    }
+#endif
+
+    if (!hashed)
+    {
+        char buf[65536];
+        ssize_t length;
+        while ((length = read(fd, buf, sizeof(buf))) > 0)
+            md5.update(buf, length);
+
+        if (length < 0)
+        {
+            close(fd);
+            return "";
+        }
+    }
+
+    close(fd);
+
+    return md5.finalize().hexdigest();
+}
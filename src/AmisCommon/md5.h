@@ -47,6 +47,8 @@ documentation and/or software.
 //      or
 //      MD5(std::string).hexdigest()
 //
+// finalize() a copy to get the digest so far and keep feeding the original
+//
 // assumes that char is 8 bit and int is 32 bit
 class MD5
 {
@@ -57,6 +59,7 @@ public:
   MD5(const std::string& text);
   void update(const unsigned char *buf, size_type length);
   void update(const char *buf, size_type length);
+  void update(const std::string& text);
   MD5& finalize();
   std::string hexdigest() const;
   friend std::ostream& operator<<(std::ostream&, MD5 md5);
@@ -90,5 +93,6 @@ private:
 };
 
 std::string md5(const std::string str);
+std::string md5file(const std::string path);
 
 #endif
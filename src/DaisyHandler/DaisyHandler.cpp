@@ -34,6 +34,7 @@
 #include "BookmarksReader.h"
 #include "BookmarksWriter.h"
 #include "FilePathTools.h"
+#include "LastmarkWriter.h"
 #include "Media.h"
 #include "Metadata.h"
 #include "OpfItemExtract.h"
@@ -51,6 +52,8 @@
 #include "BinarySmilSearch.h"
 #include "ContentNode.h"
 #include "SmilEngine.h"
+#include "SmilMediaGroupPool.h"
+#include "SmilTimeIndex.h"
 #include "SmilTreeBuilder.h"
 #include "SpineBuilder.h"
 
@@ -80,33 +83,16 @@ log4cxx::LoggerPtr amisDaisyHandlerLog(
 using namespace amis;
 using namespace std;
 
-std::string stringReplaceAll(string haystack, string needle, string replace)
-{
-    int pos = 0;
-
-    while (pos > -1)
-    {
-        pos = haystack.find(needle);
-
-        if (pos > -1)
-        {
-            haystack.replace(pos, needle.length(), replace);
-        }
-    }
-
-    return haystack;
-}
-
 amis::DaisyHandler* DaisyHandler::pinstance = 0;
 
 namespace amis {
 void *open_thread(void *handler);
+void *navparse_thread(void *handler);
+void *metadata_thread(void *handler);
+void *prescan_thread(void *handler);
 }
 
 // Local helper functions
-int currentSection(NavPoint* root, const int currentPlayOrder, bool& found);
-int countSections(NavPoint* root);
-int currentNavContainerIdx(NavContainer* list, const int currentPlayOrder);
 long parseTime(string str);
 
 /**
@@ -138,13 +124,16 @@ DaisyHandler::DaisyHandler():
         handlerMutex(), dhInstanceMutex()
 {
     mpBmk = NULL;
+    mpLastmarkWriter = new amis::LastmarkWriter();
     mFilePath = "";
     mBmkPath = "";
+    mbContentChecksum = false;
     mCurrentBookmark = -1;
     mCurrentPage = "";
 
     mpHst = NULL;
     mpCurrentMedia = NULL;
+    mpMediaGroups = new amis::SmilMediaGroupPool();
     currentPos = new amis::PositionData();
     mpTitle = NULL;
 
@@ -157,16 +146,22 @@ DaisyHandler::DaisyHandler():
     PlayFunction = NULL;
     OOPlayFunction = NULL;
     OOPlayFunctionData = NULL;
+    PrescanFunction = NULL;
+    PrescanFunctionData = NULL;
+    mbBackgroundPrescan = true;
+    OpenFunction = NULL;
 
     //Uncomment mutexattr to debug deadlocks and errors
     //pthread_mutexattr_init(&attr);
     //pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
     pthread_mutex_init(&handlerMutex, NULL);
     pthread_mutex_init(&dhInstanceMutex, NULL);
+    pthread_cond_init(&handlerCond, NULL);
 
     setState(HANDLER_CLOSED);
 
     handlerThreadActive = false;
+    prescanThreadActive = false;
     currentNaviLevel = PHRASE;
 }
 
@@ -188,15 +183,18 @@ DaisyHandler::~DaisyHandler()
     }
     if (mpCurrentMedia != NULL)
     {
-        delete mpCurrentMedia;
+        mpMediaGroups->give(mpCurrentMedia);
         mpCurrentMedia = NULL;
     }
 
+    //save a pending lastmark before the bookmark file goes away
+    mpLastmarkWriter->stop();
     if (mpBmk != NULL)
     {
         delete mpBmk;
         mpBmk = NULL;
     }
+    delete mpLastmarkWriter;
 
     if (mpHst != NULL)
     {
@@ -204,6 +202,8 @@ DaisyHandler::~DaisyHandler()
         mpHst = NULL;
     }
 
+    stopPrescan();
+
     //destroy objects!
     //LOG4CXX_DEBUG(amisDaisyHandlerLog, "destorying smilengine");
     SmilEngine::Instance()->DestroyInstance();
@@ -214,12 +214,54 @@ DaisyHandler::~DaisyHandler()
     //LOG4CXX_DEBUG(amisDaisyHandlerLog, "destorying metadata");
     amis::Metadata::Instance()->DestroyInstance();
     delete currentPos;
+    delete mpMediaGroups;
     if(unlockMutex(&dhInstanceMutex)){
         LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex unlock failed");
     }
 
     pthread_mutex_destroy(&handlerMutex);
     pthread_mutex_destroy(&dhInstanceMutex);
+    pthread_cond_destroy(&handlerCond);
+}
+
+/**
+ * Enable or disable indexing of the book timing in the background
+ *
+ * Enabled by default. When disabled the open thread parses every smil file
+ * before the book is reported open, so opening takes longer the larger the
+ * book is. Takes effect the next time a book is opened.
+ *
+ * @param enable true to build the time index after the book is open
+ */
+void DaisyHandler::setBackgroundPrescan(bool enable)
+{
+    mbBackgroundPrescan = enable;
+}
+
+/**
+ * Set the callback for time index progress
+ *
+ * @param ptr Function pointer, called with indexed files, total files and data
+ * @param data A data pointer
+ */
+void DaisyHandler::setPrescanFunction(
+        void (*ptr)(unsigned int, unsigned int, void*), void *data)
+{
+    PrescanFunction = ptr;
+    PrescanFunctionData = data;
+}
+
+/**
+ * Set the callback for a book being opened
+ *
+ * The function is called from the open thread, it must not join the thread
+ * by calling setupBook itself.
+ *
+ * @param ptr Function pointer, called with true if the book is open
+ */
+void DaisyHandler::setOpenFunction(void (*ptr)(bool))
+{
+    OpenFunction = ptr;
 }
 
 /**
@@ -289,6 +331,7 @@ void DaisyHandler::setState(HandlerState state)
         LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex lock failed");
     }
     handlerState = state;
+    pthread_cond_broadcast(&handlerCond);
     if(unlockMutex(&handlerMutex)){
         LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex unlock failed");
     }
@@ -312,6 +355,50 @@ DaisyHandler::HandlerState DaisyHandler::getState()
     return currentState;
 }
 
+/**
+ * Wait for a book being opened
+ *
+ * @param timeout Milliseconds to wait at most, 0 waits until the open is done
+ * @return Returns the state, HANDLER_OPENING if the wait timed out
+ */
+DaisyHandler::HandlerState DaisyHandler::waitForOpen(unsigned int timeout)
+{
+    struct timespec deadline;
+    if (timeout > 0)
+    {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout / 1000;
+        deadline.tv_nsec += (timeout % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    HandlerState currentState = HANDLER_CLOSED;
+    if(lockMutex(&handlerMutex)){
+        LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex lock failed");
+    }
+    while (handlerState == HANDLER_OPENING)
+    {
+        if (timeout == 0)
+        {
+            pthread_cond_wait(&handlerCond, &handlerMutex);
+        }
+        else if (pthread_cond_timedwait(&handlerCond, &handlerMutex, &deadline)
+                == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+    currentState = handlerState;
+    if(unlockMutex(&handlerMutex)){
+        LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex unlock failed");
+    }
+    return currentState;
+}
+
 /**
  * Get the file path of current file
  *
@@ -341,10 +428,12 @@ void DaisyHandler::closeBook()
     }
     if (mpCurrentMedia != NULL)
     {
-        delete mpCurrentMedia;
+        mpMediaGroups->give(mpCurrentMedia);
         mpCurrentMedia = NULL;
     }
 
+    //save a pending lastmark before the bookmark file goes away
+    mpLastmarkWriter->stop();
     if (mpBmk != NULL)
     {
         delete mpBmk;
@@ -359,6 +448,9 @@ void DaisyHandler::closeBook()
 
     mFilePath = "";
 
+    // Stop indexing before the spine goes away
+    stopPrescan();
+
     // Close book
     LOG4CXX_DEBUG(amisDaisyHandlerLog, "closing SmilEngine");
     SmilEngine::Instance()->closeBook();
@@ -376,8 +468,11 @@ void DaisyHandler::closeBook()
 /**
  * Open new media
  *
+ * The book is opened in a thread of its own, wait for it with waitForOpen or
+ * the open function before calling setupBook.
+ *
  * @param url URL to the media
- * @return Returns true on success
+ * @return Returns true if the book is being opened
  */
 bool DaisyHandler::openBook(std::string url)
 {
@@ -412,13 +507,17 @@ bool DaisyHandler::openBook(std::string url)
         break;
     }
 
+    // The prescan thread reads the spine of the book being replaced
+    stopPrescan();
+
     mFilePath = url;
     mBookInfo.mUri = url;
 
     if(lockMutex(&dhInstanceMutex)){
         LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex lock failed");
     }
-    //delete old bookmarks
+    //delete old bookmarks, saving a pending lastmark first
+    mpLastmarkWriter->stop();
     if (mpBmk != NULL)
     {
         delete mpBmk;
@@ -452,11 +551,6 @@ bool DaisyHandler::openBook(std::string url)
     if (pthread_create(&handlerThread, NULL, open_thread, this) == 0)
     {
         handlerThreadActive = true;
-#ifdef WIN32
-        Sleep(50);
-#else
-        usleep(50000);
-#endif
         return true;
     }
 
@@ -470,6 +564,11 @@ bool DaisyHandler::openBook(std::string url)
 /**
  * Open a book in a new thread
  *
+ * The navigation structure and the metadata are parsed from other files than
+ * the spine and the first smil file, so they are parsed in threads of their
+ * own while the smil engine opens the book. All of them are done before the
+ * book is open.
+ *
  * @param handler A handler pointer
  */
 void *amis::open_thread(void *handler)
@@ -480,27 +579,102 @@ void *amis::open_thread(void *handler)
 
     amis::AmisError err;
     SmilMediaGroup* pMedia = NULL;
-    pMedia = new SmilMediaGroup();
+    pMedia = h->mpMediaGroups->take();
 
-    // load the smil tree
-    LOG4CXX_DEBUG(amisDaisyHandlerLog,
-            "openthread: opening " << filename << " in smilengine");
     if(!h->lockMutex(&h->dhInstanceMutex)){
         LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex lock failed");
     }
+
+    // make the instances here, the parse threads only use them
+    NavParse::Instance();
+    Metadata::Instance();
+
+    pthread_t navThread;
+    bool navThreadActive = pthread_create(&navThread, NULL, navparse_thread,
+            h) == 0;
+    if (not navThreadActive)
+    {
+        LOG4CXX_WARN(amisDaisyHandlerLog,
+                "openthread: failed to start navparse thread");
+        navparse_thread(h);
+    }
+
+    pthread_t metadataThread;
+    bool metadataThreadActive = pthread_create(&metadataThread, NULL,
+            metadata_thread, h) == 0;
+    if (not metadataThreadActive)
+    {
+        LOG4CXX_WARN(amisDaisyHandlerLog,
+                "openthread: failed to start metadata thread");
+        metadata_thread(h);
+    }
+
+    // load the smil tree
+    LOG4CXX_DEBUG(amisDaisyHandlerLog,
+            "openthread: opening " << filename << " in smilengine");
     err = SmilEngine::Instance()->openBook(filename, pMedia);
 
+    // setupBook plays the first group, this one is not needed
+    h->mpMediaGroups->give(pMedia);
+
+    if (navThreadActive)
+        pthread_join(navThread, NULL);
+    if (metadataThreadActive)
+        pthread_join(metadataThread, NULL);
+
+    // the spine is needed for everything else, report it first
+    if (err.getCode() == amis::OK)
+        err = h->mNavOpenError;
+
+    if(!h->unlockMutex(&h->dhInstanceMutex)){
+        LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex unlock failed");
+    }
     if (err.getCode() != amis::OK)
     {
         h->setState(DaisyHandler::HANDLER_ERROR);
         h->reportGeneralError(err);
-        if(!h->unlockMutex(&h->dhInstanceMutex)){
-            LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex unlock failed");
-        }
-        pthread_exit(NULL);
+
+        if (h->OpenFunction != NULL)
+            h->OpenFunction(false);
         return NULL;
     }
 
+    // index the timing of all smil files, time jumps fall back to a binary
+    // search over the smil files if this fails
+    if (not h->mbBackgroundPrescan)
+    {
+        LOG4CXX_DEBUG(amisDaisyHandlerLog, "openthread: building time index");
+        err = SmilEngine::Instance()->buildTimeIndex(h->PrescanFunction,
+                h->PrescanFunctionData);
+        if (err.getCode() != amis::OK)
+        {
+            LOG4CXX_WARN(amisDaisyHandlerLog,
+                    "openthread: failed to build time index: " << err.getMessage());
+        }
+    }
+
+    h->setState(DaisyHandler::HANDLER_OPEN);
+
+    if (h->mbBackgroundPrescan)
+    {
+        h->startPrescan();
+    }
+
+    if (h->OpenFunction != NULL)
+        h->OpenFunction(true);
+    return NULL;
+}
+
+/**
+ * Parse the navigation structure of the book being opened
+ *
+ * @param handler A handler pointer
+ */
+void *amis::navparse_thread(void *handler)
+{
+    DaisyHandler *h = (DaisyHandler *) handler;
+
+    std::string filename = h->getFilePath();
 
     // get the navigationurl from the opf file if we are opening a DAISY3 book
     std::string ext = amis::FilePathTools::getExtension(filename);
@@ -514,22 +688,94 @@ void *amis::open_thread(void *handler)
 
     // load the navigation structure
     LOG4CXX_DEBUG(amisDaisyHandlerLog,
-            "openthread: opening " << filename << " in navparse");
-    err = NavParse::Instance()->open(filename);
-    if(!h->unlockMutex(&h->dhInstanceMutex)){
-        LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex unlock failed");
+            "navparsethread: opening " << filename << " in navparse");
+    h->mNavOpenError = NavParse::Instance()->open(filename);
+
+    return NULL;
+}
+
+/**
+ * Parse the metadata of the book being opened
+ *
+ * @param handler A handler pointer
+ */
+void *amis::metadata_thread(void *handler)
+{
+    DaisyHandler *h = (DaisyHandler *) handler;
+
+    LOG4CXX_DEBUG(amisDaisyHandlerLog, "metadatathread: loading metadata..");
+    h->mMetadataOpenError = Metadata::Instance()->openFile(h->getFilePath());
+
+    return NULL;
+}
+
+/**
+ * Index the timing of the open book in a low priority thread
+ *
+ * @param handler A handler pointer
+ */
+void *amis::prescan_thread(void *handler)
+{
+    DaisyHandler *h = (DaisyHandler *) handler;
+
+#if !defined(WIN32) && defined(SCHED_IDLE)
+    // only run when nothing else wants the cpu
+    struct sched_param param;
+    param.sched_priority = 0;
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0)
+    {
+        LOG4CXX_WARN(amisDaisyHandlerLog,
+                "prescanthread: failed to lower thread priority");
     }
+#endif
+
+    LOG4CXX_DEBUG(amisDaisyHandlerLog, "prescanthread: building time index");
+    amis::AmisError err = SmilEngine::Instance()->buildTimeIndex(
+            h->PrescanFunction, h->PrescanFunctionData);
     if (err.getCode() != amis::OK)
     {
-        h->setState(DaisyHandler::HANDLER_ERROR);
-        h->reportGeneralError(err);
+        LOG4CXX_WARN(amisDaisyHandlerLog,
+                "prescanthread: failed to build time index: " << err.getMessage());
+    }
 
-        return NULL;
+    return NULL;
+}
+
+/**
+ * Start indexing the open book in the background
+ *
+ * @return Returns true if the prescan thread was started
+ */
+bool DaisyHandler::startPrescan()
+{
+    stopPrescan();
+
+    if (pthread_create(&prescanThread, NULL, prescan_thread, this) == 0)
+    {
+        prescanThreadActive = true;
+        return true;
     }
 
-    h->setState(DaisyHandler::HANDLER_OPEN);
+    LOG4CXX_WARN(amisDaisyHandlerLog, "Failed to start prescan thread");
+    return false;
+}
 
-    return NULL;
+/**
+ * Stop a running prescan and wait for the thread to finish
+ */
+void DaisyHandler::stopPrescan()
+{
+    if (prescanThreadActive)
+    {
+        LOG4CXX_DEBUG(amisDaisyHandlerLog, "Joining prescan thread");
+        SmilTimeIndex* p_index = SmilEngine::Instance()->getTimeIndex();
+        p_index->cancel();
+        pthread_join(prescanThread, NULL);
+        prescanThreadActive = false;
+        // the thread may have finished before the cancel, which must not
+        // stop the next build
+        p_index->resetCancel();
+    }
 }
 
 /**
@@ -564,14 +810,13 @@ bool DaisyHandler::setupBook()
     }
 
     AmisError err;
-    SmilMediaGroup* pMedia = new SmilMediaGroup;
+    SmilMediaGroup* pMedia = mpMediaGroups->take();
     SmilEngine::Instance()->first(pMedia);
     // Skip the title (should always be the first element)
     //SmilEngine::Instance()->next(pMedia);
 
-    // Load the book metadata	
-    LOG4CXX_DEBUG(amisDaisyHandlerLog, "loading metadata..");
-    err = Metadata::Instance()->openFile(getFilePath());
+    // The book metadata was loaded by the open thread
+    err = mMetadataOpenError;
 
     if (err.getCode() != amis::OK)
     {
@@ -595,7 +840,11 @@ bool DaisyHandler::setupBook()
         uid = "unknown";
     }
 
-    string checksum = Metadata::Instance()->getChecksum();
+    string checksum;
+    if (mbContentChecksum)
+        checksum = Metadata::Instance()->getContentChecksum();
+    else
+        checksum = Metadata::Instance()->getChecksum();
 
     //only record bookmarks if this book has a UID
     //set uid to checksum in case the book does not have a uid
@@ -653,6 +902,9 @@ bool DaisyHandler::setupBook()
 
         if (pos_data != NULL)
         {
+            // the lastmark is played instead of the first group
+            mpMediaGroups->give(pMedia);
+
             if (pos_data->mUri.size() > 0)
             {
                 string pos = FilePathTools::goRelativePath(this->mFilePath, pos_data->mUri);
@@ -1007,6 +1259,31 @@ bool DaisyHandler::setBookmarkPath(std::string path)
     return true;
 }
 
+/**
+ * Append bookmark changes to a journal next to the bookmark file instead of
+ * rewriting the whole file for each change. Takes effect when the next book
+ * is opened.
+ *
+ * @param journal True to use a journal
+ */
+void DaisyHandler::setBookmarkJournal(bool journal)
+{
+    mpLastmarkWriter->setJournal(journal);
+}
+
+/**
+ * Identify books by a checksum of the NCC or OPF file instead of a checksum
+ * of their metadata. The bookmark file name includes the checksum, so books
+ * opened before the switch will not find their old bookmarks, and any edit
+ * of the file gives the book a new identity.
+ *
+ * @param content True to checksum the file content
+ */
+void DaisyHandler::setContentChecksum(bool content)
+{
+    mbContentChecksum = content;
+}
+
 /**
  * Set up bookmarks, either loads an existing bookmark or creates a new one
  *
@@ -1100,13 +1377,16 @@ void DaisyHandler::setupBookmarks(std::string uid, std::string checksum)
 
         if (result.getCode() == amis::OK)
         {
-            // Set the current bookmark to the last one added
-            mCurrentBookmark = p_bmk->getNumberOfItems() - 1;
             p_bmk->setUid(uid);
 
-            // Set mBmkFilePath and mpBmk pointer and return
+            // Set mBmkFilePath and mpBmk pointer, this also applies a
+            // bookmarks journal left by the last session
             mBmkFilePath = bookmark_file;
             mpBmk = p_bmk;
+            mpLastmarkWriter->start(mBmkFilePath, mpBmk);
+
+            // Set the current bookmark to the last one added
+            mCurrentBookmark = p_bmk->getNumberOfItems() - 1;
 
             return;
         }
@@ -1162,6 +1442,7 @@ void DaisyHandler::setupBookmarks(std::string uid, std::string checksum)
     // Set mBmkFilePath and mpBmk pointer and return
     mBmkFilePath = bookmark_file;
     mpBmk = p_bmk;
+    mpLastmarkWriter->start(mBmkFilePath, mpBmk);
 }
 
 /**
@@ -1276,14 +1557,13 @@ bool DaisyHandler::addBookmark()
     p_bmk->mbHasNote = true;
     p_bmk->mType = amis::PositionMark::BOOKMARK;
 
-    mpBmk->addBookmark(p_bmk);
+    bool b_saved = mpLastmarkWriter->addBookmark(p_bmk);
     //mpBmk->print();
 
     // Set the current bookmark to the last one added
     mCurrentBookmark = mpBmk->getNumberOfItems() - 1;
 
-    amis::BookmarksWriter writer;
-    if (not writer.saveFile(mBmkFilePath, mpBmk))
+    if (not b_saved)
     {
         LOG4CXX_ERROR(amisDaisyHandlerLog, "Failed to save bookmark file");
         err.setCode(amis::UNDEFINED_ERROR);
@@ -1317,9 +1597,7 @@ bool DaisyHandler::deleteCurrentBookmark()
 
     if (idx >= 0 && idx < mpBmk->getNumberOfItems())
     {
-        mpBmk->deleteItem(idx);
-        amis::BookmarksWriter writer;
-        if (not writer.saveFile(mBmkFilePath, mpBmk))
+        if (not mpLastmarkWriter->deleteItem(idx))
         {
             LOG4CXX_ERROR(amisDaisyHandlerLog, "Failed to save bookmark file");
             err.setCode(amis::UNDEFINED_ERROR);
@@ -1362,13 +1640,7 @@ bool DaisyHandler::deleteAllBookmarks()
         return false;
     }
 
-    while (mpBmk->getNumberOfItems())
-    {
-        mpBmk->deleteItem(0);
-    }
-
-    amis::BookmarksWriter writer;
-    if (not writer.saveFile(mBmkFilePath, mpBmk))
+    if (not mpLastmarkWriter->deleteAllItems())
     {
         LOG4CXX_ERROR(amisDaisyHandlerLog, "Failed to save bookmark file");
         err.setCode(amis::UNDEFINED_ERROR);
@@ -1652,6 +1924,28 @@ int DaisyHandler::getNextBookmarkId()
     return mpBmk->getMaxId() + 1;
 }
 
+/**
+ * Save a pending lastmark to the bookmark file now, the file is otherwise
+ * written a few seconds after playback moves. Call this before the
+ * application exits, e.g. from its signal or shutdown handling.
+ *
+ * @return Returns true on success
+ * @return false Returns false if the file could not be saved
+ */
+bool DaisyHandler::flushBookmarks()
+{
+    if (mpBmk == NULL)
+        return true;
+
+    if (not mpLastmarkWriter->flush())
+    {
+        LOG4CXX_WARN(amisDaisyHandlerLog, "Failed to save bookmark file");
+        return false;
+    }
+
+    return true;
+}
+
 /**
  * Increase the level granularity for navigating the book
  *
@@ -2270,7 +2564,7 @@ bool DaisyHandler::lastSection()
 bool DaisyHandler::nextPhrase(bool rewindWhenEndOfBook)
 {
     SmilMediaGroup* pMedia = NULL;
-    pMedia = new SmilMediaGroup();
+    pMedia = mpMediaGroups->take();
     if(lockMutex(&dhInstanceMutex)){
         LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex lock failed");
     }
@@ -2292,7 +2586,7 @@ bool DaisyHandler::nextPhrase(bool rewindWhenEndOfBook)
         {
 
             SmilMediaGroup* pMediaZ = NULL;
-            pMediaZ = new SmilMediaGroup();
+            pMediaZ = mpMediaGroups->take();
 
             AmisError errZ;
             errZ =
@@ -2305,8 +2599,10 @@ bool DaisyHandler::nextPhrase(bool rewindWhenEndOfBook)
                 if(unlockMutex(&dhInstanceMutex)){
                     LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex unlock failed");
                 }
+                mpMediaGroups->give(pMedia);
                 return playMediaGroup(pMediaZ);
             }
+            mpMediaGroups->give(pMediaZ);
         }
 
         if(unlockMutex(&dhInstanceMutex)){
@@ -2315,7 +2611,7 @@ bool DaisyHandler::nextPhrase(bool rewindWhenEndOfBook)
         // Store the error
         reportGeneralError(err);
 
-        delete pMedia;
+        mpMediaGroups->give(pMedia);
         return false;
     }
     else
@@ -2330,7 +2626,7 @@ bool DaisyHandler::nextPhrase(bool rewindWhenEndOfBook)
         LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex unlock failed");
     }
 
-    delete pMedia;
+    mpMediaGroups->give(pMedia);
     return false;
 }
 
@@ -2342,7 +2638,7 @@ bool DaisyHandler::nextPhrase(bool rewindWhenEndOfBook)
 bool DaisyHandler::previousPhrase()
 {
     SmilMediaGroup* pMedia = NULL;
-    pMedia = new SmilMediaGroup();
+    pMedia = mpMediaGroups->take();
 
     // Remember the current navi direction
     naviDirection = BACKWARD;
@@ -2380,10 +2676,83 @@ bool DaisyHandler::previousPhrase()
     if(unlockMutex(&dhInstanceMutex)){
         LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex unlock failed");
     }
-    delete pMedia;
+    mpMediaGroups->give(pMedia);
     return false;
 }
 
+/**
+ * Get the audio clips that will play after the current one
+ *
+ * The clips are the ones nextPhrase would play, in the same order, with the
+ * skippable structures turned off left out. They may come from the
+ * following smil files. The position in the book is not changed, so a
+ * player can queue or prebuffer the clips while the current one plays.
+ * Smil files that are not parsed yet are parsed in the background, the
+ * clips in them are returned by a later call.
+ *
+ * @param count The number of clips wanted
+ * @param items Filled with the clips, fewer than count near the end of the
+ * book or while a following smil file is parsed
+ * @return Returns true on success
+ */
+bool DaisyHandler::getPlaylist(unsigned int count,
+        std::vector<PlaylistItem>& items)
+{
+    items.clear();
+
+    if(lockMutex(&dhInstanceMutex)){
+        LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex lock failed");
+    }
+
+    vector<PlaylistClip> clips;
+    AmisError err = SmilEngine::Instance()->getPlaylist(count, clips);
+    if (err.getCode() != OK)
+    {
+        if(unlockMutex(&dhInstanceMutex)){
+            LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex unlock failed");
+        }
+        err.setMessage("Error getting playlist: " + err.getMessage());
+        reportGeneralError(err);
+        return false;
+    }
+
+    NavModel* p_nav_model = NavParse::Instance()->getNavModel();
+    int play_order = 0;
+    if (p_nav_model != NULL)
+        play_order = p_nav_model->getPlayOrder();
+
+    for (unsigned int i = 0; i < clips.size(); i++)
+    {
+        // The play order changes where the nav model would be synced
+        // to a new node, see continuePlayingMediaGroup
+        if (p_nav_model != NULL)
+        {
+            string smil_file = FilePathTools::getFileName(clips[i].mSmilFile);
+            NavNode* p_node = NULL;
+            if (clips[i].mGroupId != "")
+                p_node = p_nav_model->findHref(smil_file + "#" + clips[i].mGroupId);
+            if (p_node == NULL && clips[i].mTextId != "")
+                p_node = p_nav_model->findHref(smil_file + "#" + clips[i].mTextId);
+            if (p_node != NULL)
+                play_order = p_node->getPlayOrder();
+        }
+
+        PlaylistItem item;
+        item.file = FilePathTools::getAsLocalFilePath(clips[i].mSrc);
+        item.startms = clips[i].mClipBeginMs;
+        item.stopms = clips[i].mClipEndMs;
+        item.textId = clips[i].mTextId;
+        item.playOrder = play_order;
+        items.push_back(item);
+    }
+
+    if(unlockMutex(&dhInstanceMutex)){
+        LOG4CXX_ERROR(amisDaisyHandlerLog, "mutex unlock failed");
+    }
+
+    return true;
+}
+
 /**
  * Jump to the next section at current navi level or higher
  *
@@ -3185,71 +3554,31 @@ bool DaisyHandler::lastPage()
 /**
  * Get the index of current page
  *
- * @return Returns the index of current page
+ * The page is looked up in the position tables of the nav model, the page
+ * list cursor is not moved. Pages are counted in play order, see
+ * NavModel::getPageInPlayOrder.
+ *
+ * @return Returns the index of the last page at or before the current
+ * playorder, -1 if there is no such page
  */
 int DaisyHandler::currentPage()
 {
     NavModel* p_model = NULL;
     p_model = NavParse::Instance()->getNavModel();
-    PageTarget* p_current_page = NULL;
 
-    AmisError err;
-
-    if (p_model != NULL && p_model->hasPages() == true)
-    {
-        int mCurrentPlayOrder = p_model->getPlayOrder();
-
-        PageList* p_list = NULL;
-        p_list = p_model->getPageList();
-
-        PageTarget* p_page = NULL;
-
-        p_page = (PageTarget*) p_list->first();
-        p_current_page = (PageTarget*) p_list->previousBasedOnPlayOrder(p_model->getPlayOrder());
-
-        while (p_page != NULL)
-        {
-            string type = "unknown";
-            string text = "";
-            switch (p_page->getType())
-            {
-            case PageTarget::PAGE_FRONT:
-                type = "PAGE_FRONT";
-                break;
-            case PageTarget::PAGE_NORMAL:
-                type = "PAGE_NORMAL";
-                break;
-            case PageTarget::PAGE_SPECIAL:
-                type = "PAGE_SPECIAL";
-                break;
-            }
-
-            MediaGroup *p_label = p_page->getLabel();
-            if (p_label != NULL && p_label->hasText())
-                if (p_label->getText()->getTextString().length())
-                {
-                    text = p_label->getText()->getTextString();
-                }
-
-            LOG4CXX_DEBUG(amisDaisyHandlerLog,
-                    "text: '" << text << "' " << "type: " << type << " id: " << p_page->getId() << " playorder: " << p_page->getPlayOrder());
+    if (p_model == NULL || p_model->hasPages() == false)
+        return -1;
 
-            // Remember the current page
-            if (p_page->getPlayOrder() <= mCurrentPlayOrder)
-                p_current_page = p_page;
+    int page_idx = p_model->getPageIndex(p_model->getPlayOrder());
 
-            p_page = (PageTarget*) p_list->next();
-        }
-    }
-    else
+    if (page_idx >= 0)
     {
-        return -1;
+        //the index counts pages in play order, not in page list order
+        LOG4CXX_DEBUG(amisDaisyHandlerLog,
+                "Current page id " << p_model->getPageInPlayOrder(page_idx)->getId());
     }
 
-    LOG4CXX_DEBUG(amisDaisyHandlerLog,
-            "Current page id" << p_current_page->getId());
-
-    return 0;
+    return page_idx;
 }
 
 /**
@@ -3620,11 +3949,7 @@ if                (sscanf(tmp.c_str(), "%d of %d", &mBookInfo.mCurrentSet, &mBoo
             for (unsigned int i = 0;
                     i < mpCurrentMedia->getNumberOfAudioClips(); i++)
             {
-                string clipBegin = stringReplaceAll(
-                        mpCurrentMedia->getAudio(i)->getClipBegin(), "npt=",
-                        "");
-
-                nodestartms = parseTime(clipBegin);
+                nodestartms = mpCurrentMedia->getAudio(i)->getClipBeginMs();
 
                 //AudioNode *p_audio = mpCurrentMedia->getAudio(i);
                 //LOG4CXX_DEBUG(amisDaisyHandlerLog, "Got node " << p_audio->getId() << " clipBegin:" << startms);
@@ -3655,6 +3980,16 @@ if                (sscanf(tmp.c_str(), "%d of %d", &mBookInfo.mCurrentSet, &mBoo
         tmp = SmilEngine::Instance()->getMetadata("ncc:total-elapsed-time");
     elapsedms = parseTime(tmp);
 
+    // Fill in missing times from the time index if it has been built
+    if (indexedTimes(elapsedms, totalms) && not mBookInfo.hasTime)
+    {
+        mBookInfo.hasTime = true;
+        int seconds = totalms / 1000;
+        mBookInfo.mTotalTime.tm_hour = seconds / 3600;
+        mBookInfo.mTotalTime.tm_min = (seconds % 3600) / 60;
+        mBookInfo.mTotalTime.tm_sec = (seconds % 60);
+    }
+
     LOG4CXX_DEBUG(amisDaisyHandlerLog,
             "totalelapsedtime = " << tmp << " nodestartms = " << nodestartms/1000 << "s");
 
@@ -3802,8 +4137,7 @@ if                (sscanf(tmp.c_str(), "%d of %d", &mBookInfo.mCurrentSet, &mBoo
     mBookInfo.mSections = -1;
     if (p_nav_model != NULL and p_nav_model->getNavMap() != NULL)
     {
-        mBookInfo.mSections = countSections(
-                p_nav_model->getNavMap()->getRoot());
+        mBookInfo.mSections = p_nav_model->getNumberOfSections();
     }
 }
 
@@ -3926,11 +4260,9 @@ bool DaisyHandler::SmilMediaGroup_has_AudioRef(SmilMediaGroup *pMedia,
             p_audio = pMedia->getAudio(i);
             if (p_audio != NULL)
             {
-                string cur_audioRef = p_audio->getId();
-
-                //LOG4CXX_DEBUG(amisDaisyHandlerLog, "comparing '" << audioRef << "' to '" << cur_audioRef << "'");
+                //LOG4CXX_DEBUG(amisDaisyHandlerLog, "comparing '" << audioRef << "' to '" << p_audio->getId() << "'");
 
-                if (cur_audioRef == audioRef)
+                if (p_audio->getId() == audioRef)
                     return true;
             }
         }
@@ -3951,7 +4283,7 @@ bool DaisyHandler::loadSmilContent(std::string contentUrl, std::string audioRef,
 {
     AmisError err;
     SmilMediaGroup* pMedia = NULL;
-    pMedia = new SmilMediaGroup();
+    pMedia = mpMediaGroups->take();
 
     LOG4CXX_INFO(amisDaisyHandlerLog, "loading " << contentUrl);
     err = SmilEngine::Instance()->loadPosition(contentUrl, pMedia);
@@ -3968,8 +4300,6 @@ bool DaisyHandler::loadSmilContent(std::string contentUrl, std::string audioRef,
             LOG4CXX_DEBUG(amisDaisyHandlerLog,
                     "Searching for audioref " +audioRef);
 
-            string smil_file = SmilEngine::Instance()->getSmilSourcePath();
-            string cur_smilfile = smil_file;
             bool bFoundit = false;
 
             // check if we have the correct audioRef
@@ -3984,56 +4314,15 @@ bool DaisyHandler::loadSmilContent(std::string contentUrl, std::string audioRef,
             else
             {
                 LOG4CXX_DEBUG(amisDaisyHandlerLog,
-                        "Scanning current smilfile for correct audioRef: " << audioRef);
-            }
+                        "Looking up audioRef " << audioRef << " in current smilfile");
 
-            if (bFoundit == false)
-            {
-
-                LOG4CXX_DEBUG(amisDaisyHandlerLog,
-                        "Scanning for correct audioref");
-
-                delete pMedia;
-                pMedia = new SmilMediaGroup();
-                SmilEngine::Instance()->first(pMedia);
-
-                while (smil_file == cur_smilfile)
+                pMedia->reset();
+                err = SmilEngine::Instance()->goToAudioId(audioRef, pMedia);
+                if (err.getCode() == OK)
                 {
-
-                    if (SmilMediaGroup_has_AudioRef(pMedia, audioRef))
-                    {
-                        LOG4CXX_DEBUG(amisDaisyHandlerLog,
-                                "Found correct audioRef in " << contentUrl);
-                        bFoundit = true;
-                        break;
-
-                    }
-                    else
-                        LOG4CXX_DEBUG(amisDaisyHandlerLog,
-                                "Did not find correct audioref in " << contentUrl);
-
-                    delete pMedia;
-                    pMedia = NULL;
-                    pMedia = new SmilMediaGroup();
-
                     LOG4CXX_DEBUG(amisDaisyHandlerLog,
-                            "Going to SmilEngine->next()");
-
-                    err = SmilEngine::Instance()->next(pMedia);
-                    if (err.getCode() != OK)
-                    {
-                        LOG4CXX_DEBUG(amisDaisyHandlerLog,
-                                "SmilEngine->next() did not return amis:OK");
-                        break;
-                    }
-                    else
-                    {
-                        LOG4CXX_DEBUG(amisDaisyHandlerLog,
-                                "SmilEngine->next() returned amis:OK");
-                        // Check that we are still in the correct smilfile
-                        cur_smilfile =
-                                SmilEngine::Instance()->getSmilSourcePath();
-                    }
+                            "Found correct audioRef in " << contentUrl);
+                    bFoundit = true;
                 }
             }
 
@@ -4041,9 +4330,7 @@ bool DaisyHandler::loadSmilContent(std::string contentUrl, std::string audioRef,
             {
                 LOG4CXX_WARN(amisDaisyHandlerLog,
                         "Could not locate correct audioRef, returning " << contentUrl);
-                delete pMedia;
-                pMedia = NULL;
-                pMedia = new SmilMediaGroup();
+                pMedia->reset();
 
                 SmilEngine::Instance()->loadPosition(contentUrl, pMedia);
             }
@@ -4056,7 +4343,7 @@ bool DaisyHandler::loadSmilContent(std::string contentUrl, std::string audioRef,
     {
         //some error happened
         LOG4CXX_WARN(amisDaisyHandlerLog, "Error loading " << contentUrl);
-        delete pMedia;
+        mpMediaGroups->give(pMedia);
         reportGeneralError(err);
     }
 
@@ -4071,7 +4358,7 @@ bool DaisyHandler::loadSmilContent(std::string contentUrl, std::string audioRef,
 bool DaisyHandler::escape()
 {
     SmilMediaGroup* pMedia = NULL;
-    pMedia = new SmilMediaGroup();
+    pMedia = mpMediaGroups->take();
 
     AmisError err;
 
@@ -4081,6 +4368,7 @@ bool DaisyHandler::escape()
     {
         return playMediaGroup(pMedia);
     }
+    mpMediaGroups->give(pMedia);
     return false;
 }
 
@@ -4105,8 +4393,6 @@ bool DaisyHandler::playTitle()
     }
 
     string src;
-    string clipBegin;
-    string clipEnd;
     string audioref;
 
     if (mpTitle->getNumberOfAudioClips() > 0)
@@ -4123,18 +4409,12 @@ bool DaisyHandler::playTitle()
             audioref = p_audio->getId();
 
             src = FilePathTools::getAsLocalFilePath(src);
-            clipBegin = stringReplaceAll(mpTitle->getAudio(i)->getClipBegin(),
-                    "npt=", "");
-            clipEnd = stringReplaceAll(mpTitle->getAudio(i)->getClipEnd(),
-                    "npt=", "");
 
-            //double startms = convertToDouble(clipBegin) * 100;
-            //double stopms = convertToDouble(clipEnd) * 100;
-            long startms = parseTime(clipBegin) / 10;
-            long stopms = parseTime(clipEnd) / 10;
+            long startms = p_audio->getClipBeginMs() / 10;
+            long stopms = p_audio->getClipEndMs() / 10;
 
             LOG4CXX_DEBUG(amisDaisyHandlerLog,
-                    "playing " + audioref + src + " from " + clipBegin + " to " + clipEnd);
+                    "playing " + audioref + src + " from " + p_audio->getClipBegin() + " to " + p_audio->getClipEnd());
 
             callPlayFunction(src, (int) startms, (int) stopms);
         }
@@ -4204,7 +4484,7 @@ bool DaisyHandler::playMediaGroup(SmilMediaGroup* pMedia,
 
     if (mpCurrentMedia != NULL)
     {
-        delete mpCurrentMedia;
+        mpMediaGroups->give(mpCurrentMedia);
         mpCurrentMedia = NULL;
     }
 
@@ -4238,34 +4518,10 @@ bool DaisyHandler::playMediaGroup(SmilMediaGroup* pMedia,
  */
 long parseTime(string str)
 {
-    int h, m, s, ms;
-    bool ignore_max_seconds = false;
-
-    if (sscanf(str.c_str(), "%d:%d:%d.%d", &h, &m, &s, &ms) != 4)
-    {
-        h = m = s = ms = 0;
-        if (sscanf(str.c_str(), "%d:%d:%d", &h, &m, &s) != 3)
-        {
-            h = m = s = ms = 0;
-            if (sscanf(str.c_str(), "%d.%ds", &s, &ms) != 2)
-            {
-                LOG4CXX_WARN(amisDaisyHandlerLog,
-                        "parseTime: Failed to parse " << str);
-                return -1;
-            }
-            else
-                ignore_max_seconds = true;
-        }
-    }
-
-    if (h >= 0 && h < 300 && // Check hours
-            m >= 0 && m < 60 && // Check seconds
-            (ignore_max_seconds || (s >= 0 && s < 60)) && // Ignore seconds if we have a XX.XXXs string or check seconds
-            ms >= 0 && ms < 1000) // Check milliseconds
-        return (h * 60 * 60 + m * 60 + s) * 1000 + ms;
-
-    LOG4CXX_WARN(amisDaisyHandlerLog, "parseTime: Failed to parse " << str);
-    return -1;
+    long ms = AudioNode::clockValueToMs(str);
+    if (ms == -1)
+        LOG4CXX_WARN(amisDaisyHandlerLog, "parseTime: Failed to parse " << str);
+    return ms;
 }
 
 /**
@@ -4336,8 +4592,6 @@ void DaisyHandler::continuePlayingMediaGroup(unsigned int offsetSecond)
     }
 
     string src;
-    string clipBegin;
-    string clipEnd;
     string audioref;
 
     if (mpCurrentMedia->getNumberOfAudioClips() > 0)
@@ -4362,18 +4616,12 @@ void DaisyHandler::continuePlayingMediaGroup(unsigned int offsetSecond)
             audioref = p_audio->getId();
 
             src = FilePathTools::getAsLocalFilePath(src);
-            clipBegin = stringReplaceAll(
-                    mpCurrentMedia->getAudio(i)->getClipBegin(), "npt=", "");
-            clipEnd = stringReplaceAll(
-                    mpCurrentMedia->getAudio(i)->getClipEnd(), "npt=", "");
 
-            long startms = parseTime(clipBegin) + (offsetSecond * 1000);
-            long stopms = parseTime(clipEnd);
-            //double startms = convertToDouble(clipBegin) * 100;
-            //double stopms = convertToDouble(clipEnd) * 100;
+            long startms = p_audio->getClipBeginMs() + (offsetSecond * 1000);
+            long stopms = p_audio->getClipEndMs();
 
             LOG4CXX_DEBUG(amisDaisyHandlerLog,
-                    "**AUDIO: playing '" << audioref << "' " << src.c_str() << " from " << clipBegin.c_str() << "(" << startms << ") to " << clipEnd.c_str() << "(" << stopms << ") **");
+                    "**AUDIO: playing '" << audioref << "' " << src.c_str() << " from " << p_audio->getClipBegin() << "(" << startms << ") to " << p_audio->getClipEnd() << "(" << stopms << ") **");
 
             //LOG4CXX_DEBUG(amisDaisyHandlerLog, "Calling play function for " << src << " " << startms << "->" << stopms);
             if (!callPlayFunction(src, (int) startms / 10, (int) stopms / 10))
@@ -4430,17 +4678,11 @@ void DaisyHandler::continuePlayingMediaGroup(unsigned int offsetSecond)
             p_pos->mNcxRef = p_node->getId();
             p_pos->mPlayOrder = p_node->getPlayOrder();
 
-            mpBmk->setLastmark(p_pos);
+            //the writer thread saves the file once the lastmarks settle
+            mpLastmarkWriter->setLastmark(p_pos);
 
             //LOG4CXX_WARN(amisDaisyHandlerLog,  "Printing lastmark");
             //mpBmk->printPositionData(p_pos);
-
-            BookmarksWriter writer;
-            if (not writer.saveFile(mBmkFilePath, mpBmk))
-            {
-                // only warn here
-                LOG4CXX_WARN(amisDaisyHandlerLog, "Failed to save bookmark file");
-            }
         }
 
     }
@@ -4500,8 +4742,6 @@ bool DaisyHandler::syncPosInfo()
 {
     string tmp = "";
 
-    static int lastPlayOrder = -1;
-
     tmp = Metadata::Instance()->getMetadata("ncc:totaltime");
     if (tmp.length() == 0)
         tmp = Metadata::Instance()->getMetadata("dtb:totaltime");
@@ -4514,42 +4754,52 @@ bool DaisyHandler::syncPosInfo()
         tmp = SmilEngine::Instance()->getMetadata("ncc:total-elapsed-time");
     mPosInfo.currentSmilms = parseTime(tmp);
 
+    // Fill in missing times from the time index if it has been built
+    indexedTimes(mPosInfo.currentSmilms, mPosInfo.totalSmilms);
+
     NavModel* p_nav_model = NULL;
     p_nav_model = NavParse::Instance()->getNavModel();
 
     if (p_nav_model != NULL)
     {
-
+        // Look up the section and page at the current playorder
         int currentPlayOrder = p_nav_model->getPlayOrder();
 
-        // If playorder has changed since last sync..
-        if (currentPlayOrder != lastPlayOrder)
-        {
+        mPosInfo.currentSectionIdx = p_nav_model->getSectionIndex(
+                currentPlayOrder);
 
-            // ..synchronize current section index using playorder
-            if (p_nav_model->getNavMap() != NULL)
-            {
-                bool found = false;
-                int cursec = currentSection(p_nav_model->getNavMap()->getRoot(),
-                        currentPlayOrder, found);
-                if (found)
-                    mPosInfo.currentSectionIdx = cursec;
-                else
-                    mPosInfo.currentSectionIdx = -1;
-            }
+        if (p_nav_model->hasPages())
+            mPosInfo.currentPageIdx = p_nav_model->getPageIndex(
+                    currentPlayOrder);
+        else
+            mPosInfo.currentPageIdx = -1;
+    }
 
-            // ..and synchronize current section index using playorder
-            if (p_nav_model->hasPages())
-            {
-                mPosInfo.currentPageIdx = currentNavContainerIdx(
-                        p_nav_model->getPageList(), currentPlayOrder);
-            }
-            else
-            {
-                mPosInfo.currentPageIdx = -1;
-            }
-        }
-        lastPlayOrder = currentPlayOrder;
+    return true;
+}
+
+/**
+ * Replace times missing from the metadata with times from the time index
+ *
+ * @param elapsedms Start of the current smil file, -1 if unknown
+ * @param totalms Total time of the book, -1 if unknown
+ * @return Returns true if the index is ready and was consulted
+ */
+bool DaisyHandler::indexedTimes(long& elapsedms, long& totalms)
+{
+    SmilTimeIndex* p_index = SmilEngine::Instance()->getTimeIndex();
+    if (not p_index->isReady())
+        return false;
+
+    if (totalms == -1)
+        totalms = p_index->getTotalDuration();
+
+    if (elapsedms == -1)
+    {
+        int idx = p_index->findSmilFile(
+                SmilEngine::Instance()->getSmilSourcePath());
+        if (idx >= 0)
+            elapsedms = p_index->getSmilEntry(idx)->mStart;
     }
 
     return true;
@@ -4813,42 +5063,32 @@ bool DaisyHandler::syncNavModel(std::string ncxref, int playorder)
         LOG4CXX_DEBUG(amisDaisyHandlerLog,
                 "Trying to sync navmap to playorder " << playorder);
         NavModel *p_nav_model = NavParse::Instance()->getNavModel();
-        NavMap *p_nav_map = NULL;
 
-        NavPoint *p_node = (NavPoint*) p_nav_model->getNavMap()->first();
+        // Look up the first navnode at or after the play order, this also
+        // makes it the current node of the nav map
+        NavPoint *p_node =
+                (NavPoint*) p_nav_model->getNavMap()->syncNearestPlayOrder(
+                        playorder);
 
-        // Go trough each navnode until we find one we want
-        while (p_node != NULL)
+        if (p_node != NULL)
         {
-            if (p_node->getPlayOrder() >= playorder)
-            {
-                LOG4CXX_WARN(amisDaisyHandlerLog,
-                        "Syncing navmap to playorder:" << currentPos->mNcxRef);
-
-                if (p_nav_model != NULL)
-                    p_nav_map = p_nav_model->getNavMap();
+            LOG4CXX_WARN(amisDaisyHandlerLog,
+                    "Syncing navmap to playorder:" << currentPos->mNcxRef);
 
-                if (p_nav_map != NULL)
-                    p_nav_map->updateCurrent(p_node);
-                if (p_nav_model != NULL)
-                    p_nav_model->syncLists(p_node->getPlayOrder());
+            p_nav_model->syncLists(p_node->getPlayOrder());
 
-                p_nav_model->updatePlayOrder(p_node->getPlayOrder());
+            p_nav_model->updatePlayOrder(p_node->getPlayOrder());
 
-                MediaGroup *p_label = p_node->getLabel();
-                if (p_label != NULL && p_label->hasText())
-                {
-                    LOG4CXX_INFO(amisDaisyHandlerLog,
-                            "NCXREF: '" << p_label->getText()->getTextString() << "'");
-                }
-
-                syncPosInfo();
-
-                return true;
+            MediaGroup *p_label = p_node->getLabel();
+            if (p_label != NULL && p_label->hasText())
+            {
+                LOG4CXX_INFO(amisDaisyHandlerLog,
+                        "NCXREF: '" << p_label->getText()->getTextString() << "'");
             }
 
-            p_node =
-                    (NavPoint*) NavParse::Instance()->getNavModel()->getNavMap()->next();
+            syncPosInfo();
+
+            return true;
         }
     }
 
@@ -5063,131 +5303,102 @@ void DaisyHandler::printNavNodes()
 }
 
 /**
- * Check if the audio node contains given time segment
+ * Load the audio clip playing at a time in a smil file and sync the navigation model
  *
- * @param audionode The audio node to search in
- * @param offsetSeconds Start of segment
- * @param remainingOffset End of segment
- * @return true if segment is found and false if it is not found
+ * @param smilPath The smil file to load
+ * @param ms Time from the start of the smil file in milliseconds
+ * @return Returns true if the position was loaded
  */
-bool audioNodeContainsTime(AudioNode* audionode, unsigned int offsetSeconds,
-        unsigned int& remainingOffset)
+bool DaisyHandler::loadTimePosition(std::string smilPath, unsigned long ms)
 {
-    string clipBegin = stringReplaceAll(audionode->getClipBegin(), "npt=", "");
-    string clipEnd = stringReplaceAll(audionode->getClipEnd(), "npt=", "");
+    AmisError err;
+    SmilMediaGroup* pMedia = mpMediaGroups->take();
+    unsigned long clipOffset = 0;
+    vector<string> textrefs;
 
-    long begTime = parseTime(clipBegin);
-    long endTime = parseTime(clipEnd);
+    LOG4CXX_INFO(amisDaisyHandlerLog,
+            "loading " << ms << " ms in " << smilPath);
+    err = SmilEngine::Instance()->loadTime(smilPath, ms, pMedia, clipOffset,
+            textrefs);
 
-    if ((begTime / 1000) < offsetSeconds && offsetSeconds < (endTime / 1000))
+    if (err.getCode() != OK)
     {
-        remainingOffset = offsetSeconds - (begTime / 1000);
-        return true;
+        LOG4CXX_WARN(amisDaisyHandlerLog, "Error loading " << smilPath);
+        mpMediaGroups->give(pMedia);
+        reportGeneralError(err);
+        return false;
     }
 
-    return false;
-}
-
-/**
- * Search for audio ref recursively in nodes
- *
- * @param node Current node
- * @param offset Offset for current node
- * @param containerid Id for the container node
- * @param audioref Audio ref to search for
- * @param textrefs Vector of textrefs
- * @param remainingOffset The remaining offset
- * @return Returns true if audio ref is found, and false if node is NULL or ref is not found
- */
-bool findAudioRefRecursive(Node* node, unsigned int offset, string& containerid,
-        string& audioref, vector<string>& textrefs,
-        unsigned int& remainingOffset)
-{
-    if (node == NULL)
-        return false;
+    bool smilContentLoaded = playMediaGroup(pMedia, clipOffset / 1000);
 
-    while (node != NULL)
+    if (smilContentLoaded)
     {
-        // A TimeContainer is either a SeqNode or a ParNode
-        TimeContainerNode* timecontainer =
-                dynamic_cast<TimeContainerNode*>(node);
-        if (timecontainer != NULL)
+        // Locate the correct position in the navmap
+        bool syncSuccess = false;
+        vector<string>::const_reverse_iterator rev_iter = textrefs.rbegin();
+        while (not syncSuccess and (rev_iter != textrefs.rend()))
         {
-            //LOG4CXX_DEBUG(amisDaisyHandlerLog, "TimeContainerNode with " << timecontainer->NumChildren() << " children");
-            for (int i = 0; i < timecontainer->NumChildren(); ++i)
-            {
-                if (findAudioRefRecursive(timecontainer->getChild(i), offset,
-                        containerid, audioref, textrefs, remainingOffset))
-                {
-                    if (containerid.empty())
-                    {
-                        // pick up the first non empty container id on the way back
-                        containerid = timecontainer->getElementId();
-                    }
-                    // Found audio ref
-                    return true;
-                }
-            }
-
+            const string previous_textref = *rev_iter;
+            ++rev_iter;
+            syncSuccess = syncNavModel(smilPath, previous_textref);
         }
-        else
+        if (not syncSuccess)
         {
-            // A ContentNode contains a MediaNode which is either Audio, Text, or Image
-            ContentNode* contentnode = dynamic_cast<ContentNode*>(node);
-            if (contentnode != NULL)
-            {
-                MediaNode* media = contentnode->getMediaNode();
-                AudioNode* audionode = dynamic_cast<AudioNode*>(media);
-                if (audionode != NULL)
-                {
-                    if (audioNodeContainsTime(audionode, offset,
-                            remainingOffset))
-                    {
-                        audioref = audionode->getId();
-                        return true;
-                    }
-                }
-
-                TextNode* textnode = dynamic_cast<TextNode*>(media);
-                if (textnode != NULL)
-                {
-                    textrefs.push_back(textnode->getId());
-                }
-            }
+            ostringstream oss;
+            oss << "Failed to syncNavModel to any of the located textrefs ( ";
+            copy(textrefs.rbegin(), textrefs.rend(),
+                    std::ostream_iterator<const string>(oss, " "));
+            oss << " ) at " << ms << " ms in " << smilPath << endl;
+            LOG4CXX_INFO(amisDaisyHandlerLog, oss.str());
         }
-        node = node->getFirstSibling();
     }
 
-    return false;
-}
-
-/**
- * Searches for the closest audio ref to offset
- *
- * @param tree The smil tree to look in
- * @param offset The offset to find
- * @param containerid The container id
- * @param audioref The audio reference
- * @param textrefs The text reference
- * @param remainingOffset The remaining offset
- * @return Returns true if found
- */
-bool findClosestAudioRef(SmilTree* tree, unsigned int offset,
-        string& containerid, string& audioref, vector<string>& textrefs,
-        unsigned int& remainingOffset)
-{
-    return findAudioRefRecursive(tree->getRoot(), offset, containerid, audioref,
-            textrefs, remainingOffset);
+    return smilContentLoaded;
 }
 
 /**
  * Jump to a given second
  *
+ * Uses the time index of the book when it has been built and falls back to a
+ * binary search over the smil files otherwise.
+ *
  * @param seconds The target second
  * @return Returns true if the jump was done.
  */
 bool DaisyHandler::jumpToSecond(unsigned int seconds)
 {
+    SmilTimeIndex* p_index = SmilEngine::Instance()->getTimeIndex();
+    if (p_index->isReady())
+    {
+        int smilIdx = 0;
+        int clipIdx = -1;
+        unsigned long clipOffset = 0;
+        if (not p_index->lookup((unsigned long) seconds * 1000, smilIdx,
+                clipIdx, clipOffset))
+        {
+            LOG4CXX_WARN(amisDaisyHandlerLog,
+                    "JUMP TO SECOND: " << seconds << " is beyond the end of the book");
+            return false;
+        }
+
+        const SmilTimeIndex::SmilEntry* p_entry = p_index->getSmilEntry(smilIdx);
+        LOG4CXX_INFO(amisDaisyHandlerLog,
+                "Smil file: " << p_entry->mSmilPath << " contains " << seconds << " seconds position");
+
+        unsigned long smilOffset = 0;
+        if (clipIdx >= 0)
+        {
+            smilOffset = p_entry->mClips[clipIdx].mOffset + clipOffset;
+        }
+        else
+        {
+            LOG4CXX_WARN(amisDaisyHandlerLog,
+                    "JUMP TO SECOND: Audio ref not found, starting from beginning of smil file");
+        }
+
+        return loadTimePosition(p_entry->mSmilPath, smilOffset);
+    }
+
     BinarySmilSearch search;
     SmilTreeBuilder* treebuilder = search.begin();
     BinarySmilSearch::searchDirection direction = BinarySmilSearch::DOWN;
@@ -5205,60 +5416,15 @@ bool DaisyHandler::jumpToSecond(unsigned int seconds)
                 {
                     LOG4CXX_INFO(amisDaisyHandlerLog,
                             "Smil file: " << search.getCurrentSmilPath() << " contains " << seconds << " seconds position");
-                    SmilTree* tree = search.getCurrentSmilTree();
                     string smilStartsAtStr = treebuilder->getMetadata(
                             "ncc:totalelapsedtime");
                     unsigned int offset = seconds
                             - stringToSeconds(smilStartsAtStr);
                     LOG4CXX_INFO(amisDaisyHandlerLog,
                             "Looking for offset=" << offset << "s");
-                    string containerid;
-                    string audioref;
-                    vector<string> textrefs;
-                    unsigned int remainingOffset = 0;
-                    bool audioRefFound = findClosestAudioRef(tree, offset,
-                            containerid, audioref, textrefs, remainingOffset);
-                    if (not audioRefFound)
-                    {
-                        LOG4CXX_WARN(amisDaisyHandlerLog,
-                                "JUMP TO SECOND: Audio ref not found, starting from beginning of smil file");
-                    }
-                    if (not containerid.empty())
-                    {
-                        containerid = "#" + containerid;
-                    }
-                    bool smilContentLoaded = loadSmilContent(
-                            search.getCurrentSmilPath() + containerid, audioref,
-                            remainingOffset);
-
-                    if (smilContentLoaded)
-                    {
-                        // Locate the correct position in the navmap
-                        bool syncSuccess = false;
-                        vector<string>::const_reverse_iterator rev_iter =
-                                textrefs.rbegin();
-                        while (not syncSuccess and (rev_iter != textrefs.rend()))
-                        {
-                            const string previous_textref = *rev_iter;
-                            ++rev_iter;
-                            syncSuccess = syncNavModel(
-                                    search.getCurrentSmilPath(),
-                                    previous_textref);
-                        }
-                        if (not syncSuccess)
-                        {
-                            ostringstream oss;
-                            oss
-                                    << "Failed to syncNavModel to any of the located textrefs ( ";
-                            copy(textrefs.rbegin(), textrefs.rend(),
-                                    std::ostream_iterator<const string>(oss,
-                                            " "));
-                            oss << " ) for audioref: " << audioref << endl;
-                            LOG4CXX_INFO(amisDaisyHandlerLog, oss.str());
-                        }
-                    }
 
-                    return smilContentLoaded;
+                    return loadTimePosition(search.getCurrentSmilPath(),
+                            (unsigned long) offset * 1000);
                 }
                 direction = BinarySmilSearch::UP;
             }
@@ -5273,99 +5439,6 @@ bool DaisyHandler::jumpToSecond(unsigned int seconds)
     return false;
 }
 
-/**
- * Returns index of current section
- *
- * @param root The root node to start from
- * @param currentPlayOrder The playorder to look for
- * @param found Boolean indikating if the wanted item was found
- * @return Returns the index or -1 if not found
- */
-int currentSection(NavPoint* root, const int currentPlayOrder, bool& found)
-{
-    if (root == NULL)
-        return -1;
-
-    // In case playorder is == we are at that idx
-    if (root->getPlayOrder() == currentPlayOrder)
-    {
-        found = true;
-        return 0;
-    }
-
-    // In case playorder > we have gone too far, abort and return previous idx
-    if (root->getPlayOrder() > currentPlayOrder)
-    {
-        found = true;
-        return -1;
-    }
-
-    int childCount = root->getNumChildren();
-    int countedChildren = 0;
-    for (int cnt = 0; cnt < childCount; ++cnt)
-    {
-        NavPoint* node = root->getChild(cnt);
-
-        countedChildren += currentSection(node, currentPlayOrder, found) + 1;
-        if (found)
-            break;
-    }
-
-    return countedChildren;
-}
-
-/**
- * Count sections in a navigation tree
- *
- * @param root The root node to start from
- * @return Returns the number of sections in tree
- */
-int countSections(NavPoint* root)
-{
-    if (root == NULL)
-        return -1;
-
-    int childCount = root->getNumChildren();
-    int countedChildren = 0;
-    for (int cnt = 0; cnt < childCount; ++cnt)
-    {
-        NavPoint* node = root->getChild(cnt);
-
-        countedChildren += countSections(node) + 1;
-    }
-
-    return countedChildren;
-}
-
-/**
- * Get the index of given play order item
- *
- * @param list The list of nodes
- * @param currentPlayOrder Playorder item wanted
- * @return Returns the index for the item with given playorder
- */
-int currentNavContainerIdx(NavContainer* list, const int currentPlayOrder)
-{
-    if (list == NULL)
-        return -1;
-
-    NavNode* node = list->first();
-
-    int index = -1;
-
-    while (node != NULL)
-    {
-        // We want index to return the position of the 
-        // previous node so store all we traverse
-        if (node->getPlayOrder() <= currentPlayOrder)
-            index++;
-
-        node = list->next();
-    }
-
-    return index;
-}
-
 /**
  * Convert a time to string
  *
@@ -45,9 +45,11 @@ class HistoryRecorder;
 namespace amis
 {
 class BookmarkFile;
+class LastmarkWriter;
 class PositionData;
 class MediaGroup;
 class SmilMediaGroup;
+class SmilMediaGroupPool;
 
 // This class encapsulates the Daisy book handling functions
 class DAISYHANDLER_API DaisyHandler
@@ -62,6 +64,8 @@ public:
 
     // Initialization
     bool setBookmarkPath(std::string path);
+    void setBookmarkJournal(bool journal);
+    void setContentChecksum(bool content);
 
     // Opens a book, gets associated bookmarks, sets up stuff necessary for playback
     bool openBook(std::string);
@@ -92,6 +96,10 @@ public:
     HandlerState getState();
     void setState(HandlerState);
 
+    // Waits until a book being opened is open or has failed to open and
+    // returns the state, waits at most timeout milliseconds unless it is 0
+    HandlerState waitForOpen(unsigned int timeout = 0);
+
     // Function gets called when daisyhandler wants to play audio
     void setPlayFunction(bool (*ptr)(std::string, long long, long long));
 
@@ -100,6 +108,21 @@ public:
     void setPlayFunction(bool (*ptr)(std::string, long long, long long, void *),
             void *);
 
+    // Index the book timing on a low priority thread after the book is open
+    // instead of before (the default), time jumps use a slower search until
+    // it is done
+    void setBackgroundPrescan(bool);
+
+    // Function gets called from the prescan thread with the number of
+    // indexed smil files, the total and the data pointer, the index is
+    // ready when the numbers match
+    void setPrescanFunction(void (*ptr)(unsigned int, unsigned int, void *),
+            void *);
+
+    // Function gets called from the open thread when a book is open, or
+    // with false when it failed to open, setupBook can be called after it
+    void setOpenFunction(void (*ptr)(bool));
+
     /**
      * Available navigation levels
      */
@@ -282,11 +305,27 @@ public:
     int getNextBookmarkId();
     bool deleteCurrentBookmark();
     bool deleteAllBookmarks();
+    bool flushBookmarks();
 
     // Phrase Navigation
     bool nextPhrase(bool rewindWhenEndOfBook = false);
     bool previousPhrase();
 
+    /**
+     * An audio clip that playback will reach, for queuing it ahead of time
+     */
+    struct PlaylistItem
+    {
+        std::string file; /**< local path of the audio file */
+        long startms; /**< start of the clip (ms) in the file */
+        long stopms; /**< end of the clip (ms) in the file */
+        std::string textId; /**< id of the text played with the clip */
+        int playOrder; /**< play order of the nav node the clip belongs to */
+    };
+    // Returns the next clips after the current one without moving,
+    // for gapless playback
+    bool getPlaylist(unsigned int count, std::vector<PlaylistItem>& items);
+
     // Section Navigation
     bool nextSection();
     bool previousSection();
@@ -321,10 +360,12 @@ public:
 
 private:
     amis::BookmarkFile* mpBmk;
+    amis::LastmarkWriter* mpLastmarkWriter;
     amis::PositionData* currentPos;
     amis::MediaGroup* mpTitle;
     HistoryRecorder* mpHst;
     SmilMediaGroup* mpCurrentMedia;
+    SmilMediaGroupPool* mpMediaGroups;
     amis::AmisError lastError;
 
     enum NaviDirection
@@ -354,14 +395,22 @@ private:
     bool callOOPlayFunction(std::string, long long, long long);
     void *OOPlayFunctionData;
 
+    void (*PrescanFunction)(unsigned int, unsigned int, void*);
+    void *PrescanFunctionData;
+    bool mbBackgroundPrescan;
+
+    void (*OpenFunction)(bool);
+
     void continuePlayingMediaGroup(unsigned int offsetSecond = 0);
     bool syncPosInfo();
+    bool indexedTimes(long& elapsedms, long& totalms);
     bool syncNavModel(std::string uri, std::string textref);
     bool syncNavModel(std::string ncxref = "", int playorder = -1);
     inline double convertToDouble(const std::string& s);
     inline int convertToInt(const std::string& s);
 
     bool playMediaGroup(SmilMediaGroup* pMedia, unsigned int offsetSecond = 0);
+    bool loadTimePosition(std::string smilPath, unsigned long ms);
 
     SmilMediaGroup* getCurrentMediaGroup();
     std::string getBookFilePath();
@@ -383,6 +432,7 @@ private:
     bool mbStartAtLastmark;
     bool mbContinueFromLastmark;
     bool mbFlagNoSync;
+    bool mbContentChecksum;
 
     std::string mFilePath;
     std::string mBmkPath;
@@ -390,8 +440,14 @@ private:
     std::string mLastmarkUri;
 
     friend void *open_thread(void *handler);
+    friend void *navparse_thread(void *handler);
+    friend void *metadata_thread(void *handler);
     void join_threads();
 
+    friend void *prescan_thread(void *handler);
+    bool startPrescan();
+    void stopPrescan();
+
 protected:
     // Private data
     time_t autonaviStartTime;
@@ -404,9 +460,18 @@ protected:
     // Threading used when opening a book
     pthread_t handlerThread;
     bool handlerThreadActive;
+    // Results of the parses run next to the smil engine when opening a book
+    amis::AmisError mNavOpenError;
+    amis::AmisError mMetadataOpenError;
+
+    // Threading used when indexing a book in the background
+    pthread_t prescanThread;
+    bool prescanThreadActive;
 
     pthread_mutex_t dhInstanceMutex;
     pthread_mutex_t handlerMutex;
+    // Signals state changes to threads waiting for a book to open
+    pthread_cond_t handlerCond;
     pthread_mutexattr_t attr;
 private:
     static DaisyHandler* pinstance;
@@ -31,8 +31,12 @@
  *
  */
 
+#include <algorithm>
+#include <utility>
+
 #include "NavContainer.h"
 
+using namespace std;
 using namespace amis;
 
 NavContainer::NavContainer()
@@ -91,28 +95,20 @@ amis::NavNode* NavContainer::current()
  */
 amis::NavNode* NavContainer::nextBasedOnPlayOrder(int playOrder)
 {
-    int closest = 0;
-    int nodeOrder;
-    int nodeIdx = 0;
-    bool found = false;
+    if (mpNodes.size() == 0)
+        return NULL;
 
-    for (unsigned int i = 0; i < mpNodes.size(); i++)
-    {
-        nodeOrder = mpNodes[i]->getPlayOrder();
-
-        //if this node comes after and it's closer than our current closest value
-        if (nodeOrder > playOrder && (!found || nodeOrder < closest))
-        {
-            found = true;
-            nodeIdx = i;
-            closest = nodeOrder;
-        }
-    }
+    if (mPlayOrderView.size() != mpNodes.size())
+        createPlayOrderView();
 
-    if(found){
-        return mpNodes[nodeIdx];
-    }
+    //the first node that comes after, the earliest in the list on a tie
+    vector<int>::iterator it = upper_bound(mSortedPlayOrders.begin(),
+            mSortedPlayOrders.end(), playOrder);
 
+    if (it != mSortedPlayOrders.end())
+    {
+        return mpNodes[mPlayOrderView[it - mSortedPlayOrders.begin()]];
+    }
 
     //LOG4CXX_ERROR(amisPageListLog, "Page node with larger play order not found, returning last page in list");
     return mpNodes.back();
@@ -125,29 +121,72 @@ amis::NavNode* NavContainer::nextBasedOnPlayOrder(int playOrder)
  */
 amis::NavNode* NavContainer::previousBasedOnPlayOrder(int playOrder)
 {
-    int closest = 0;
-    int nodeOrder;
-    int nodeIdx = 0;
-    bool found = false;
+    if (mpNodes.size() == 0)
+        return NULL;
 
-    for (unsigned int i = 0; i < mpNodes.size(); i++)
-    {
-        nodeOrder = mpNodes[i]->getPlayOrder();
-
-        //if this node comes before and it's closer than our current closest value
-        if (nodeOrder < playOrder && (!found || nodeOrder > closest))
-        {
-            found = true;
-            nodeIdx = i;
-            closest = nodeOrder;
-        }
-    }
+    if (mPlayOrderView.size() != mpNodes.size())
+        createPlayOrderView();
 
-    if(found){
-        return mpNodes[nodeIdx];
+    vector<int>::iterator it = lower_bound(mSortedPlayOrders.begin(),
+            mSortedPlayOrders.end(), playOrder);
+
+    if (it != mSortedPlayOrders.begin())
+    {
+        //the closest node that comes before, the earliest in the list on a tie
+        it = lower_bound(mSortedPlayOrders.begin(), it, *(it - 1));
+        return mpNodes[mPlayOrderView[it - mSortedPlayOrders.begin()]];
     }
 
     //LOG4CXX_ERROR(amisPageListLog, "Page node with smaller play order not found, returning first page in list");
     return mpNodes.front();
 }
 
+/**
+ * Find a node with the given play order
+ *
+ * @param playOrder The play order to look for
+ * @return index of the first node in the list with this play order, -1 if none
+ */
+int NavContainer::findPlayOrder(int playOrder)
+{
+    if (mPlayOrderView.size() != mpNodes.size())
+        createPlayOrderView();
+
+    vector<int>::iterator it = lower_bound(mSortedPlayOrders.begin(),
+            mSortedPlayOrders.end(), playOrder);
+
+    if (it != mSortedPlayOrders.end() && *it == playOrder)
+    {
+        return mPlayOrderView[it - mSortedPlayOrders.begin()];
+    }
+
+    return -1;
+}
+
+/**
+ * Sort the nodes by play order
+ *
+ * The view is rebuilt whenever the number of nodes has changed, nodes with
+ * the same play order keep their order in the list.
+ */
+void NavContainer::createPlayOrderView()
+{
+    vector<pair<int, unsigned int> > orders;
+    orders.reserve(mpNodes.size());
+
+    for (unsigned int i = 0; i < mpNodes.size(); i++)
+    {
+        orders.push_back(make_pair(mpNodes[i]->getPlayOrder(), i));
+    }
+
+    sort(orders.begin(), orders.end());
+
+    mSortedPlayOrders.resize(orders.size());
+    mPlayOrderView.resize(orders.size());
+    for (unsigned int i = 0; i < orders.size(); i++)
+    {
+        mSortedPlayOrders[i] = orders[i].first;
+        mPlayOrderView[i] = orders[i].second;
+    }
+}
+
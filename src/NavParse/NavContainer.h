@@ -23,6 +23,8 @@
 #ifndef NAVCONTAINER_H
 #define NAVCONTAINER_H
 
+#include <vector>
+
 #include "Media.h"
 #include "NavNode.h"
 
@@ -40,7 +42,6 @@ public:
     virtual amis::NavNode* last() = 0;
     virtual void updateCurrent(amis::NavNode*) = 0;
     virtual amis::NavNode* syncPlayOrder(int) = 0;
-    virtual amis::NavNode* goToContentRef(std::string) = 0;
     virtual amis::NavNode* goToId(std::string) = 0;
 
     amis::NavNode* previousBasedOnPlayOrder(int playOrder);
@@ -57,10 +58,19 @@ public:
     amis::NavNode* current();
 
 protected:
+    int findPlayOrder(int);
+
     std::vector<amis::NavNode*> mpNodes;
     amis::NavNode* mpCurrent;
 
 private:
+    void createPlayOrderView();
+
+    //!play orders of mpNodes in ascending order
+    std::vector<int> mSortedPlayOrders;
+    //!index in mpNodes of each entry in mSortedPlayOrders
+    std::vector<unsigned int> mPlayOrderView;
+
     amis::MediaGroup* mpLabel;
     amis::MediaGroup* mpNavInfo;
     std::string mId;
@@ -60,8 +60,6 @@ NavList::NavList()
 //--------------------------------------------------
 NavList::~NavList()
 {
-    deleteCache();
-
     int sz = mpNodes.size();
     NavNode* tmp_node;
 
@@ -184,26 +182,13 @@ int NavList::getLength()
 }
 
 //--------------------------------------------------
-//go to a certain node, based on play order
+//get a node by its index without moving the current node
 //--------------------------------------------------
-NavNode* NavList::syncPlayOrder(int playOrder)
+NavNode* NavList::getNode(unsigned int index)
 {
-    bool b_found = false;
-
-    for (unsigned int i = 0; i < mpNodes.size(); i++)
+    if (index < mpNodes.size())
     {
-        if (mpNodes[i]->getPlayOrder() == playOrder)
-        {
-            mCurrentIndex = i;
-            b_found = true;
-            break;
-        }
-    }
-
-    if (b_found == true)
-    {
-        mpCurrent = mpNodes[mCurrentIndex];
-        return mpNodes[mCurrentIndex];
+        return mpNodes[index];
     }
     else
     {
@@ -211,51 +196,25 @@ NavNode* NavList::syncPlayOrder(int playOrder)
     }
 }
 
-NavNode* NavList::goToContentRef(std::string contentHref)
+//--------------------------------------------------
+//go to a certain node, based on play order
+//--------------------------------------------------
+NavNode* NavList::syncPlayOrder(int playOrder)
 {
-    if (mpNavListCache.size() == 0)
-        createCache();
+    int idx = findPlayOrder(playOrder);
 
-    map<const char *, int>::const_iterator iter = mpNavListCache.find(
-            contentHref.c_str());
-    if (iter != mpNavListCache.end())
+    if (idx >= 0)
     {
-        //cout << "Got node from map " << iter->first << " at index " << iter->second << endl;
-        mCurrentIndex = iter->second;
+        mCurrentIndex = idx;
         mpCurrent = mpNodes[mCurrentIndex];
         return mpNodes[mCurrentIndex];
     }
-
-    return NULL;
-}
-
-void NavList::createCache()
-{
-    string content_href;
-    string content_target;
-
-    for (unsigned int i = 0; i < mpNodes.size(); i++)
+    else
     {
-        content_href = mpNodes[i]->getContent();
-        content_target = amis::FilePathTools::getTarget(content_href);
-        content_href = amis::FilePathTools::getFileName(content_href);
-        content_href += "#";
-        content_href += content_target;
-
-        const char *tmp = strdup(content_href.c_str());
-        mpNavListCache.insert(make_pair(tmp, i));
+        return NULL;
     }
 }
 
-void NavList::deleteCache()
-{
-    LOG4CXX_DEBUG(amisNavListLog, "deleting mpNavListCache");
-
-    map<const char *, int>::const_iterator iter;
-    for (iter = mpNavListCache.begin(); iter != mpNavListCache.end(); ++iter)
-        free((void *) iter->first);
-}
-
 NavNode* NavList::goToId(std::string id)
 {
     bool b_found = false;
@@ -49,6 +49,7 @@ public:
     ~NavList();
     void addNode(NavNode*);
     int getLength();
+    amis::NavNode* getNode(unsigned int);
 
     //overrides
     amis::NavNode* next();
@@ -57,27 +58,13 @@ public:
     amis::NavNode* last();
 
     amis::NavNode* syncPlayOrder(int);
-    amis::NavNode* goToContentRef(std::string);
     amis::NavNode* goToId(std::string);
     void updateCurrent(amis::NavNode*);
 
-    void createCache();
-    void deleteCache();
-
     void print();
 
 private:
     unsigned int mCurrentIndex;
-
-    struct ltstr
-    {
-        bool operator()(const char* s1, const char* s2) const
-        {
-            return std::strcmp(s1, s2) < 0;
-        }
-    };
-
-    std::map<const char *, int, ltstr> mpNavListCache;
 };
 
 }
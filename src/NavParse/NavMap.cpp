@@ -36,6 +36,7 @@
 #include "NavContainer.h"
 #include "NavMap.h"
 #include <cstdlib>
+#include <algorithm>
 #include <log4cxx/logger.h>
 
 // create logger which will become a child to logger kolibre.amis
@@ -53,7 +54,6 @@ NavMap::NavMap()
 
 NavMap::~NavMap()
 {
-    deleteCache();
     delete mpRoot;
 }
 
@@ -165,28 +165,15 @@ void NavMap::updateCurrent(amis::NavNode* pNode)
 //find the node with this play order
 amis::NavNode* NavMap::syncPlayOrder(int playOrder)
 {
-    amis::NavPoint* p_node = (amis::NavPoint*) first();
-
     LOG4CXX_DEBUG(amisNavMapLog, "NavMap::syncPlayOrder(): searching for " << playOrder );
 
-    bool b_found = false;
-
-    while (b_found == false && p_node != NULL)
-    {
-        if (p_node->getPlayOrder() == playOrder)
-        {
-            b_found = true;
-        }
-        else
-        {
-            p_node = p_node->next();
-        }
-    }
+    int idx = findPlayOrderIndex(playOrder);
 
-    if (b_found == true)
+    if (idx < (int) mPlayOrderIndex.size()
+            && mPlayOrderIndex[idx]->getPlayOrder() == playOrder)
     {
-        LOG4CXX_DEBUG(amisNavMapLog, "Found it!! " << p_node->getPlayOrder());
-        mpCurrent = p_node;
+        LOG4CXX_DEBUG(amisNavMapLog, "Found it!! " << playOrder);
+        setCurrentNode(mPlayOrderIndex[idx]);
         return mpCurrent;
     }
     else
@@ -196,53 +183,86 @@ amis::NavNode* NavMap::syncPlayOrder(int playOrder)
     }
 }
 
-//make the current nav point the one with this smil ref if exists
-amis::NavNode* NavMap::goToContentRef(const std::string contentHref)
+//find the first node with a play order not less than this one
+amis::NavNode* NavMap::syncNearestPlayOrder(int playOrder)
 {
-    if (mpNavMapCache.size() == 0)
-        createCache();
+    int idx = findPlayOrderIndex(playOrder);
 
-    map<const char *, NavPoint *>::const_iterator iter = mpNavMapCache.find(
-            contentHref.c_str());
-    if (iter != mpNavMapCache.end())
+    if (idx < (int) mPlayOrderIndex.size())
     {
-        LOG4CXX_DEBUG(amisNavMapLog, "Got node from map " << iter->first);
-        mpCurrent = iter->second;
+        setCurrentNode(mPlayOrderIndex[idx]);
         return mpCurrent;
     }
 
     return NULL;
 }
 
-void NavMap::createCache()
+//comparison used to sort and search the play order index
+static bool playOrderLess(amis::NavPoint* pNode, int playOrder)
 {
-    NavPoint* p_node = (NavPoint*) first();
+    return pNode->getPlayOrder() < playOrder;
+}
 
-    string content_href;
-    string content_target;
+static bool navPointLess(amis::NavPoint* pNode1, amis::NavPoint* pNode2)
+{
+    return pNode1->getPlayOrder() < pNode2->getPlayOrder();
+}
 
-    while (p_node != NULL)
-    {
-        content_href = p_node->getContent();
-        content_target = amis::FilePathTools::getTarget(content_href);
-        content_href = amis::FilePathTools::getFileName(content_href);
-        content_href += "#";
-        content_href += content_target;
+//index of the first node with a play order not less than this one
+int NavMap::findPlayOrderIndex(int playOrder)
+{
+    if (mPlayOrderIndex.size() == 0)
+        createPlayOrderIndex();
 
-        const char *tmp = strdup(content_href.c_str());
-        mpNavMapCache.insert(make_pair(tmp, p_node));
+    return lower_bound(mPlayOrderIndex.begin(), mPlayOrderIndex.end(),
+            playOrder, playOrderLess) - mPlayOrderIndex.begin();
+}
 
-        p_node = p_node->next();
+//--------------------------------------------------
+/*!
+ make a node current and leave the child counters along its path as a walk
+ with next() from first() would have, so that next() and previous() continue
+ from this node
+ */
+//--------------------------------------------------
+void NavMap::setCurrentNode(amis::NavPoint* pNode)
+{
+    pNode->resetChildCount();
+
+    amis::NavPoint* p_child = pNode;
+    amis::NavPoint* p_parent = pNode->getParent();
+    while (p_parent != NULL)
+    {
+        p_parent->setChildCount(p_child->getChildIndex());
+        p_child = p_parent;
+        p_parent = p_parent->getParent();
     }
+
+    mpCurrent = pNode;
 }
 
-void NavMap::deleteCache()
+//--------------------------------------------------
+/*!
+ collect all nav points in document order and sort them by play order, the
+ map must be fully loaded first
+ */
+//--------------------------------------------------
+void NavMap::createPlayOrderIndex()
 {
-    LOG4CXX_DEBUG(amisNavMapLog, "deleting mpNavMapCache");
+    mPlayOrderIndex.clear();
+
+    NavPoint* p_node = (NavPoint*) first();
+    while (p_node != NULL)
+    {
+        mPlayOrderIndex.push_back(p_node);
+        p_node = p_node->next();
+    }
+
+    //play orders normally follow document order already
+    stable_sort(mPlayOrderIndex.begin(), mPlayOrderIndex.end(), navPointLess);
 
-    map<const char *, NavPoint *>::const_iterator iter;
-    for (iter = mpNavMapCache.begin(); iter != mpNavMapCache.end(); ++iter)
-        free((void *) iter->first);
+    LOG4CXX_DEBUG(amisNavMapLog,
+            "Indexed " << mPlayOrderIndex.size() << " nav points by play order");
 }
 
 NavNode* NavMap::first()
@@ -54,31 +54,26 @@ public:
     amis::NavNode* last();
     void updateCurrent(amis::NavNode*);
     amis::NavNode* syncPlayOrder(int);
-    amis::NavNode* goToContentRef(std::string);
+    amis::NavNode* syncNearestPlayOrder(int);
     amis::NavNode* goToId(std::string);
     int getNumberOfSubsections();
 
     int getMaxDepth();
-    void createCache();
-    void deleteCache();
+    void createPlayOrderIndex();
 
     void recordNewDepth(int);
     void setRoot(amis::NavPoint*);
 
 private:
 
+    int findPlayOrderIndex(int);
+    void setCurrentNode(amis::NavPoint*);
+
     amis::NavPoint* mpRoot;
     int mMaxDepth;
 
-    struct ltstr
-    {
-        bool operator()(const char* s1, const char* s2) const
-        {
-            return strcmp(s1, s2) < 0;
-        }
-    };
-
-    std::map<const char *, amis::NavPoint *, ltstr> mpNavMapCache;
+    //!all nav points sorted by play order
+    std::vector<amis::NavPoint *> mPlayOrderIndex;
 };
 
 }
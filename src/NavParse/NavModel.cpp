@@ -32,11 +32,24 @@
  */
 
 #include "NavModel.h"
+#include "FilePathTools.h"
 #include <iostream>
+#include <algorithm>
+#include <log4cxx/logger.h>
+
+// create logger which will become a child to logger kolibre.amis
+log4cxx::LoggerPtr amisNavModelLog(
+        log4cxx::Logger::getLogger("kolibre.amis.navmodel"));
 
 using namespace std;
 using namespace amis;
 
+//order pages by play order, pages with the same play order keep list order
+static bool pagePlaysBefore(PageTarget* pFirst, PageTarget* pSecond)
+{
+    return pFirst->getPlayOrder() < pSecond->getPlayOrder();
+}
+
 NavModel::NavModel()
 {
     mpDocTitle = NULL;
@@ -65,6 +78,10 @@ NavModel::NavModel()
     mpNavMap->setRoot(p_root);
 
     mGlobalPlayOrder = 0;
+
+    mTableFirstPlayOrder = 0;
+    mbPositionTablesReady = false;
+    mbHrefIndexReady = false;
 }
 
 NavModel::~NavModel()
@@ -136,6 +153,200 @@ int NavModel::getPlayOrder()
     return mGlobalPlayOrder;
 }
 
+/**
+ * Build the tables used by getSectionIndex and getPageIndex
+ *
+ * The section and page index of every play order between the lowest and the
+ * highest play order in the model is stored in a table, so that looking up
+ * the position during playback is a single array access. Books with very
+ * sparse play orders only keep the sorted play orders and are searched.
+ */
+void NavModel::createPositionTables()
+{
+    mSectionPlayOrders.clear();
+    mSectionMaxPlayOrders.clear();
+    mPagesInPlayOrder.clear();
+    mPagePlayOrders.clear();
+    mSectionIndexTable.clear();
+    mPageIndexTable.clear();
+
+    //walk the tree directly so the current nav point is left alone
+    addSectionPlayOrders(mpNavMap->getRoot());
+
+    PageTarget* p_page = mpPageList->getPage(0);
+    for (unsigned int i = 1; p_page != NULL; i++)
+    {
+        mPagesInPlayOrder.push_back(p_page);
+        p_page = mpPageList->getPage(i);
+    }
+    stable_sort(mPagesInPlayOrder.begin(), mPagesInPlayOrder.end(),
+            pagePlaysBefore);
+    for (unsigned int i = 0; i < mPagesInPlayOrder.size(); i++)
+        mPagePlayOrders.push_back(mPagesInPlayOrder[i]->getPlayOrder());
+
+    mbPositionTablesReady = true;
+
+    int first_play_order = 0;
+    int last_play_order = -1;
+    if (mSectionPlayOrders.size() > 0)
+    {
+        first_play_order = *min_element(mSectionPlayOrders.begin(),
+                mSectionPlayOrders.end());
+        last_play_order = mSectionMaxPlayOrders.back();
+    }
+    if (mPagePlayOrders.size() > 0)
+    {
+        if (last_play_order < first_play_order
+                || mPagePlayOrders.front() < first_play_order)
+            first_play_order = mPagePlayOrders.front();
+        if (mPagePlayOrders.back() > last_play_order)
+            last_play_order = mPagePlayOrders.back();
+    }
+
+    //play orders are normally numbered without gaps, don't let a book with
+    //huge gaps allocate a table much larger than the model itself
+    long range = (long) last_play_order - first_play_order + 1;
+    long entries = mSectionPlayOrders.size() + mPagePlayOrders.size();
+    if (range <= 0 || range > 4 * entries + 256)
+    {
+        LOG4CXX_DEBUG(amisNavModelLog,
+                "No position tables for play orders " << first_play_order << "-" << last_play_order);
+        return;
+    }
+
+    mTableFirstPlayOrder = first_play_order;
+    mSectionIndexTable.resize(range);
+    mPageIndexTable.resize(range);
+    for (long i = 0; i < range; i++)
+    {
+        mSectionIndexTable[i] = findSectionIndex(first_play_order + i);
+        mPageIndexTable[i] = findPageIndex(first_play_order + i);
+    }
+
+    LOG4CXX_DEBUG(amisNavModelLog,
+            "Created position tables for " << mSectionPlayOrders.size() << " sections and " << mPagePlayOrders.size() << " pages");
+}
+
+/**
+ * Get the section index at a play order
+ *
+ * The index counts the sections of the nav map in document order starting
+ * from 1, the section at the play order or the last one before it is
+ * returned. 0 means the play order comes before the first section.
+ *
+ * @param playOrder The play order to look for
+ * @return Returns the index or -1 if the play order is after all sections
+ */
+int NavModel::getSectionIndex(int playOrder)
+{
+    if (mbPositionTablesReady == false)
+        createPositionTables();
+
+    unsigned int offset = playOrder - mTableFirstPlayOrder;
+    if (offset < mSectionIndexTable.size())
+        return mSectionIndexTable[offset];
+
+    return findSectionIndex(playOrder);
+}
+
+/**
+ * Get the page index at a play order
+ *
+ * The pages are counted in play order, which is not always the order of
+ * the page list. getPageInPlayOrder gives the page for the index.
+ *
+ * @param playOrder The play order to look for
+ * @return Returns the index of the last page at or before the play order or
+ * -1 if there is no such page
+ */
+int NavModel::getPageIndex(int playOrder)
+{
+    if (mbPositionTablesReady == false)
+        createPositionTables();
+
+    unsigned int offset = playOrder - mTableFirstPlayOrder;
+    if (offset < mPageIndexTable.size())
+        return mPageIndexTable[offset];
+
+    return findPageIndex(playOrder);
+}
+
+/**
+ * Get a page by its index in play order
+ *
+ * @param idx An index returned by getPageIndex
+ * @return Returns the page or NULL if the index is out of range
+ */
+PageTarget* NavModel::getPageInPlayOrder(int idx)
+{
+    if (mbPositionTablesReady == false)
+        createPositionTables();
+
+    if (idx < 0 || (unsigned int) idx >= mPagesInPlayOrder.size())
+        return NULL;
+
+    return mPagesInPlayOrder[idx];
+}
+
+/**
+ * Get the number of sections in the nav map
+ *
+ * @return Returns the number of nav points below the root
+ */
+int NavModel::getNumberOfSections()
+{
+    if (mbPositionTablesReady == false)
+        createPositionTables();
+
+    return mSectionPlayOrders.size();
+}
+
+//add the play orders of the children of a nav point in document order
+void NavModel::addSectionPlayOrders(NavPoint* pNode)
+{
+    if (pNode == NULL)
+        return;
+
+    for (int i = 0; i < pNode->getNumChildren(); i++)
+    {
+        NavPoint* p_child = pNode->getChild(i);
+        int max_play_order = p_child->getPlayOrder();
+        if (mSectionMaxPlayOrders.size() > 0
+                && mSectionMaxPlayOrders.back() > max_play_order)
+            max_play_order = mSectionMaxPlayOrders.back();
+
+        mSectionPlayOrders.push_back(p_child->getPlayOrder());
+        mSectionMaxPlayOrders.push_back(max_play_order);
+
+        addSectionPlayOrders(p_child);
+    }
+}
+
+//a document order walk stops at the first section with a play order at or
+//above the wanted one, which is where the running maximum first reaches it
+int NavModel::findSectionIndex(int playOrder)
+{
+    vector<int>::iterator it = lower_bound(mSectionMaxPlayOrders.begin(),
+            mSectionMaxPlayOrders.end(), playOrder);
+    if (it == mSectionMaxPlayOrders.end())
+        return -1;
+
+    int pos = it - mSectionMaxPlayOrders.begin();
+    if (mSectionPlayOrders[pos] == playOrder)
+        return pos + 1;
+
+    return pos;
+}
+
+//count the pages at or before the play order
+int NavModel::findPageIndex(int playOrder)
+{
+    vector<int>::iterator it = upper_bound(mPagePlayOrders.begin(),
+            mPagePlayOrders.end(), playOrder);
+
+    return (it - mPagePlayOrders.begin()) - 1;
+}
+
 //@bug
 //last section at any level returns no pages
 int NavModel::getNumberOfPagesInCurrentSection()
@@ -282,51 +493,113 @@ amis::AmisError NavModel::goToId(std::string id, NavPoint*& pNode)
     return err;
 }
 
+/**
+ * Go to the node with the given content reference
+ *
+ * The nav map is searched first, then the page list and then the nav lists
+ * in order, the first match becomes the current node of its container.
+ *
+ * @param href The content reference in the form file#id
+ * @return Returns the node or NULL if not found
+ */
 NavNode* NavModel::goToHref(std::string href)
 {
-    amis::AmisError err;
-    err.setCode(amis::OK);
+    if (mbHrefIndexReady == false)
+        createHrefIndex();
 
-    NavNode* p_temp;
-    NavList* p_list;
+    tr1::unordered_map<string, HrefTarget>::const_iterator iter =
+            mHrefIndex.find(href);
+    if (iter == mHrefIndex.end())
+        return NULL;
 
-    p_temp = NULL;
+    NavNode* p_temp = iter->second.mpNode;
+    iter->second.mpContainer->updateCurrent(p_temp);
 
-    p_temp = mpNavMap->goToContentRef(href);
+    this->mGlobalPlayOrder = p_temp->getPlayOrder();
 
-    if (p_temp == NULL)
+    return p_temp;
+}
+
+/**
+ * Find the node with the given content reference without going to it
+ *
+ * @param href The content reference in the form file#id
+ * @return Returns the node goToHref would go to, or NULL if not found
+ */
+NavNode* NavModel::findHref(std::string href)
+{
+    if (mbHrefIndexReady == false)
+        createHrefIndex();
+
+    tr1::unordered_map<string, HrefTarget>::const_iterator iter =
+            mHrefIndex.find(href);
+    if (iter == mHrefIndex.end())
+        return NULL;
+
+    return iter->second.mpNode;
+}
+
+/**
+ * Build the index used by goToHref
+ *
+ * Nodes are added in the order goToHref searches the containers and the
+ * first node with a reference is kept, so the index finds the same node as
+ * searching each container in turn.
+ */
+void NavModel::createHrefIndex()
+{
+    mHrefIndex.clear();
+
+    //walk the tree directly so the current nav point is left alone
+    addNavPointHrefs(mpNavMap->getRoot());
+
+    PageTarget* p_page = mpPageList->getPage(0);
+    for (unsigned int i = 1; p_page != NULL; i++)
     {
-        if (this->hasPages() == true)
-        {
-            p_temp = this->mpPageList->goToContentRef(href);
-        }
+        addHref(p_page->getContent(), p_page, mpPageList);
+        p_page = mpPageList->getPage(i);
     }
 
-    if (p_temp == NULL)
+    for (unsigned int i = 0; i < mpNavLists.size(); i++)
     {
-        if (this->getNumberOfNavLists() > 0)
-        {
-            for (unsigned int i = 0; i < this->getNumberOfNavLists(); i++)
-            {
-                p_list = this->getNavList(i);
+        NavList* p_list = mpNavLists[i];
+        for (int j = 0; j < p_list->getLength(); j++)
+            addHref(p_list->getNode(j)->getContent(), p_list->getNode(j),
+                    p_list);
+    }
 
-                p_temp = p_list->goToContentRef(href);
+    mbHrefIndexReady = true;
 
-                if (p_temp != NULL)
-                {
-                    break;
-                }
-            }
-        }
-    }
+    LOG4CXX_DEBUG(amisNavModelLog,
+            "Indexed " << mHrefIndex.size() << " content references");
+}
 
-    //return err;
-    if (p_temp != NULL)
+//add the content references of the children of a nav point
+void NavModel::addNavPointHrefs(NavPoint* pNode)
+{
+    if (pNode == NULL)
+        return;
+
+    for (int i = 0; i < pNode->getNumChildren(); i++)
     {
-        this->mGlobalPlayOrder = p_temp->getPlayOrder();
+        NavPoint* p_child = pNode->getChild(i);
+        addHref(p_child->getContent(), p_child, mpNavMap);
+        addNavPointHrefs(p_child);
     }
+}
 
-    return p_temp;
+//add a content reference unless an earlier node already has it
+void NavModel::addHref(string content, NavNode* pNode,
+        NavContainer* pContainer)
+{
+    string href = amis::FilePathTools::getFileName(content);
+    href += "#";
+    href += amis::FilePathTools::getTarget(content);
+
+    HrefTarget target;
+    target.mpNode = pNode;
+    target.mpContainer = pContainer;
+    mHrefIndex.insert(make_pair(href, target));
 }
 
 amis::MediaGroup* NavModel::getDocAuthor()
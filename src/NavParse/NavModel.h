@@ -27,6 +27,9 @@
 #pragma warning(disable : 4251)
 #endif
 
+#include <string>
+#include <tr1/unordered_map>
+
 #include "NavList.h"
 #include "PageList.h"
 #include "NavPoint.h"
@@ -51,6 +54,7 @@ public:
     amis::AmisError goToSection(std::string, amis::NavPoint*&);
     amis::AmisError goToId(std::string, amis::NavPoint*&);
     amis::NavNode* goToHref(std::string);
+    amis::NavNode* findHref(std::string);
 
     amis::MediaGroup* getDocAuthor();
     amis::MediaGroup* getDocTitle();
@@ -81,7 +85,23 @@ public:
     void updatePlayOrder(int);
     int getPlayOrder();
 
+    //position lookups based on play order, the model must be fully loaded
+    void createPositionTables();
+    int getSectionIndex(int);
+    int getPageIndex(int);
+    amis::PageTarget* getPageInPlayOrder(int);
+    int getNumberOfSections();
+
+    //href lookups in all containers, the model must be fully loaded
+    void createHrefIndex();
+
 private:
+    void addSectionPlayOrders(amis::NavPoint*);
+    void addNavPointHrefs(amis::NavPoint*);
+    void addHref(std::string, amis::NavNode*, amis::NavContainer*);
+    int findSectionIndex(int);
+    int findPageIndex(int);
+
     NavMap* mpNavMap;
     amis::PageList* mpPageList;
     std::vector<amis::NavList*> mpNavLists;
@@ -94,6 +114,29 @@ private:
     std::vector<amis::CustomTest*> mpSmilCustomTest;
 
     int mGlobalPlayOrder;
+
+    //play orders of the sections in document order, without the root
+    std::vector<int> mSectionPlayOrders;
+    //highest play order seen up to each section
+    std::vector<int> mSectionMaxPlayOrders;
+    //the pages and their play orders, sorted by play order
+    std::vector<amis::PageTarget*> mPagesInPlayOrder;
+    std::vector<int> mPagePlayOrders;
+    //section and page index for each play order from mTableFirstPlayOrder
+    std::vector<int> mSectionIndexTable;
+    std::vector<int> mPageIndexTable;
+    int mTableFirstPlayOrder;
+    bool mbPositionTablesReady;
+
+    //a node in the href index and the container it belongs to
+    struct HrefTarget
+    {
+        amis::NavNode* mpNode;
+        amis::NavContainer* mpContainer;
+    };
+    //nodes of the nav map, page list and nav lists by file#id
+    std::tr1::unordered_map<std::string, HrefTarget> mHrefIndex;
+    bool mbHrefIndexReady;
 };
 
 }
@@ -156,6 +156,14 @@ amis::AmisError NavParse::open(std::string filepath)
     //read the file and fill in the data structure
     err = mpFileReader->open(mFilePath, mpNavModel);
 
+    //index the loaded model for play order and position lookups
+    if (err.getCode() == amis::OK)
+    {
+        mpNavModel->getNavMap()->createPlayOrderIndex();
+        mpNavModel->createPositionTables();
+        mpNavModel->createHrefIndex();
+    }
+
     return err;
 }
 
@@ -50,6 +50,7 @@ NavPoint::NavPoint()
     mpParent = NULL;
     mpFirstChild = NULL;
     mChildCount = -1;
+    mChildIndex = 0;
 
     mTypeOfNode = amis::NavNode::NAV_POINT;
 }
@@ -93,6 +94,26 @@ void NavPoint::resetChildCount()
     mChildCount = -1;
 }
 
+/**
+ * Set the child count as if next() had just returned a child
+ *
+ * @param index The index of the child being traversed
+ */
+void NavPoint::setChildCount(int index)
+{
+    mChildCount = index;
+}
+
+/**
+ * Get the position of this node among its parent's children
+ *
+ * @return Returns the 0-based child index
+ */
+int NavPoint::getChildIndex()
+{
+    return mChildIndex;
+}
+
 /**
  * Navigate to the next child
  *
@@ -307,6 +328,8 @@ void NavPoint::addSibling(NavPoint* pNode)
  */
 void NavPoint::addChild(NavPoint* pNode)
 {
+    pNode->mChildIndex = mNumChildren;
+
     //check if first child does not exist
     if (mNumChildren == 0 || mpFirstChild == NULL)
     {
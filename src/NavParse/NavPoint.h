@@ -43,6 +43,8 @@ public:
     NavPoint* previous();
 
     void resetChildCount();
+    void setChildCount(int);
+    int getChildIndex();
     int getNumChildren();
 
     void addChild(NavPoint*);
@@ -60,6 +62,8 @@ private:
     int mNumChildren;
     NavPoint* mpParent;
     int mChildCount;
+    //!position of this node among its parent's children
+    int mChildIndex;
 
 };
 
@@ -59,8 +59,6 @@ PageList::PageList()
  */
 PageList::~PageList()
 {
-    deleteCache();
-
     int sz = mpNodes.size();
     NavNode* tmp_node;
 
@@ -164,6 +162,19 @@ void PageList::updateCurrent(NavNode* pNewCurrent)
 {
     NavNode* p_temp;
 
+    //pages know their own index
+    if (pNewCurrent != NULL
+            && pNewCurrent->getTypeOfNode() == NavNode::PAGE_TARGET)
+    {
+        unsigned int index = ((PageTarget*) pNewCurrent)->getIndex();
+        if (index < mpNodes.size() && mpNodes[index] == pNewCurrent)
+        {
+            mpCurrent = pNewCurrent;
+            mCurrentIndex = index;
+            return;
+        }
+    }
+
     //find mpCurrent in the list
     for (unsigned int i = 0; i < mpNodes.size(); i++)
     {
@@ -188,6 +199,24 @@ int PageList::getLength()
     return mpNodes.size();
 }
 
+/**
+ * Get a page by its index without moving the current node
+ *
+ * @param index of the page
+ * @return the page or NULL if the index is out of range
+ */
+PageTarget* PageList::getPage(unsigned int index)
+{
+    if (index < mpNodes.size())
+    {
+        return (PageTarget*) mpNodes[index];
+    }
+    else
+    {
+        return NULL;
+    }
+}
+
 /**
  * Count the number of pages in the given range
  *
@@ -256,20 +285,11 @@ PageTarget* PageList::findPage(std::string pageLabel)
  */
 NavNode* PageList::syncPlayOrder(int playOrder)
 {
-    bool b_found = false;
+    int idx = findPlayOrder(playOrder + 1);
 
-    for (unsigned int i = 0; i < mpNodes.size(); i++)
-    {
-        if (mpNodes[i]->getPlayOrder() == playOrder + 1)
-        {
-            mCurrentIndex = i;
-            b_found = true;
-            break;
-        }
-    }
-
-    if (b_found == true)
+    if (idx >= 0)
     {
+        mCurrentIndex = idx;
         mpCurrent = mpNodes[mCurrentIndex];
         return mpNodes[mCurrentIndex];
     }
@@ -279,31 +299,6 @@ NavNode* PageList::syncPlayOrder(int playOrder)
     }
 }
 
-/**
- * Go to a certain node based on href
- *
- * @param contentHref The wanted href
- * @return The new current node, or NULL if not found
- */
-NavNode* PageList::goToContentRef(const std::string contentHref)
-{
-
-    if (mpPageListCache.size() == 0)
-        createCache();
-
-    map<const char *, int>::const_iterator iter = mpPageListCache.find(
-            contentHref.c_str());
-    if (iter != mpPageListCache.end())
-    {
-        mCurrentIndex = iter->second;
-        mpCurrent = mpNodes[mCurrentIndex];
-        return mpNodes[mCurrentIndex];
-    }
-
-    return NULL;
-
-}
-
 /**
  * Go to a certain node with the given id
  *
@@ -335,39 +330,6 @@ NavNode* PageList::goToId(std::string id)
     }
 }
 
-/**
- * Create the node cache
- */
-void PageList::createCache()
-{
-    string content_href;
-    string content_target;
-
-    for (unsigned int i = 0; i < mpNodes.size(); i++)
-    {
-        content_href = mpNodes[i]->getContent();
-        content_target = amis::FilePathTools::getTarget(content_href);
-        content_href = amis::FilePathTools::getFileName(content_href);
-        content_href += "#";
-        content_href += content_target;
-
-        const char *tmp = strdup(content_href.c_str());
-        mpPageListCache.insert(make_pair(tmp, i));
-    }
-}
-
-/**
- * Delete the node cache
- */
-void PageList::deleteCache()
-{
-    LOG4CXX_DEBUG(amisPageListLog, "deleting mpPageListCache");
-
-    map<const char *, int>::const_iterator iter;
-    for (iter = mpPageListCache.begin(); iter != mpPageListCache.end(); ++iter)
-        free((void *) iter->first);
-}
-
 /**
  * Print the page list to console
  */
@@ -51,6 +51,7 @@ public:
     void addNode(amis::PageTarget*);
     int getLength();
     int countPagesInRange(int, int);
+    PageTarget* getPage(unsigned int);
 
     //overrides
     amis::NavNode* first();
@@ -58,30 +59,15 @@ public:
     amis::NavNode* previous();
     amis::NavNode* last();
     amis::NavNode* syncPlayOrder(int);
-    amis::NavNode* goToContentRef(std::string);
     amis::NavNode* goToId(std::string);
     void updateCurrent(amis::NavNode*);
     PageTarget* findPage(std::string);
 
-    void createCache();
-    void deleteCache();
-
     void print();
 
 private:
 
     unsigned int mCurrentIndex;
-
-    struct ltstr
-    {
-        bool operator()(const char* s1, const char* s2) const
-        {
-            return std::strcmp(s1, s2) < 0;
-        }
-    };
-
-    std::map<const char *, int, ltstr> mpPageListCache;
-
 };
 
 }
@@ -36,6 +36,7 @@ using namespace amis;
 PageTarget::PageTarget()
 {
     this->mTypeOfNode = NavNode::PAGE_TARGET;
+    mIndex = -1;
 }
 
 PageTarget::~PageTarget()
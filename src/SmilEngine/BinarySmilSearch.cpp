@@ -52,6 +52,17 @@ unsigned int stringToSeconds(string timeString)
     return seconds;
 }
 
+BinarySmilSearch::BinarySmilSearch() :
+        upperSmilIdx(0), currentSmilIdx(0), lowerSmilIdx(0),
+        currentSmilTree(NULL), currentSmilTreeBuilt(false)
+{
+}
+
+BinarySmilSearch::~BinarySmilSearch()
+{
+    delete currentSmilTree;
+}
+
 SmilTreeBuilder* BinarySmilSearch::buildTree(int id)
 {
     LOG4CXX_DEBUG(amisBinarySmilSearchLog, "Trying smil id: " << id);
@@ -62,18 +73,41 @@ SmilTreeBuilder* BinarySmilSearch::buildTree(int id)
     //Share daisyversion between files
     currentTreeBuilder.setDaisyVersion(
             SmilEngine::Instance()->getDaisyVersion());
-    currentSmilTree = SmilTree();
+    delete currentSmilTree;
+    currentSmilTree = new SmilTree();
+    currentSmilTreeBuilt = false;
+    // The probes only need the timing metadata in the head
     if (amis::OK
-            == currentTreeBuilder.createSmilTree(&currentSmilTree,
-                    currentSmilPath).getCode())
+            == currentTreeBuilder.readSmilHead(currentSmilPath).getCode())
     {
         return &currentTreeBuilder;
     }
 
-    LOG4CXX_ERROR(amisBinarySmilSearchLog, "Failed to build smil tree for " << currentSmilPath);
+    LOG4CXX_ERROR(amisBinarySmilSearchLog, "Failed to read smil head for " << currentSmilPath);
     return NULL;
 }
 
+bool BinarySmilSearch::buildCurrentTree()
+{
+    if (currentSmilTreeBuilt)
+        return true;
+    if (currentSmilTree == NULL)
+        return false;
+
+    LOG4CXX_DEBUG(amisBinarySmilSearchLog, "Building full smil tree for " << currentSmilPath);
+
+    if (amis::OK
+            != currentTreeBuilder.createSmilTree(currentSmilTree,
+                    currentSmilPath).getCode())
+    {
+        LOG4CXX_ERROR(amisBinarySmilSearchLog, "Failed to build smil tree for " << currentSmilPath);
+        return false;
+    }
+
+    currentSmilTreeBuilt = true;
+    return true;
+}
+
 bool BinarySmilSearch::currentSmilIsBeyond(unsigned int seconds)
 {
     string smilStartingAt;
@@ -109,17 +143,25 @@ bool BinarySmilSearch::currentSmilContains(unsigned int seconds)
     if (currentSmilIsBeyond(seconds))
         return false;
 
-    unsigned int timeInThisSmilSeconds = currentSmilTree.getSmilDuration();
-    if (timeInThisSmilSeconds == 0)
+    // Prefer the duration from the head, the full tree is only built when
+    // the smil file does not declare it
+    unsigned int timeInThisSmilSeconds = 0;
+    string timeInThisSmil = currentTreeBuilder.getMetadata(
+            "ncc:timeinthissmil");
+    if (not timeInThisSmil.empty())
+    {
+        timeInThisSmilSeconds = stringToSeconds(timeInThisSmil);
+    }
+    else
     {
-        string timeInThisSmil = currentTreeBuilder.getMetadata(
-                "ncc:timeinthissmil");
-        //Check if the timeinthissmil was defined
-        if (timeInThisSmil.empty())
+        if (not buildCurrentTree())
+            throw 0;
+        timeInThisSmilSeconds = currentSmilTree->getSmilDuration();
+        //Check if the duration could be calculated
+        if (timeInThisSmilSeconds == 0)
         {
             throw 0;
         }
-        timeInThisSmilSeconds = stringToSeconds(timeInThisSmil);
     }
 
     string smilStartingAt;
@@ -209,5 +251,8 @@ string BinarySmilSearch::getCurrentSmilPath()
 
 SmilTree* BinarySmilSearch::getCurrentSmilTree()
 {
-    return &currentSmilTree;
+    if (not buildCurrentTree())
+        return NULL;
+
+    return currentSmilTree;
 }
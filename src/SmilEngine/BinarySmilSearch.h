@@ -37,6 +37,9 @@ public:
         DOWN, UP
     };
 
+    BinarySmilSearch();
+    ~BinarySmilSearch();
+
     SmilTreeBuilder* begin();
     SmilTreeBuilder* next(searchDirection);
 
@@ -46,14 +49,19 @@ public:
     std::string getCurrentSmilPath();
     SmilTree* getCurrentSmilTree();
 private:
+    BinarySmilSearch(const BinarySmilSearch&);
+    BinarySmilSearch& operator=(const BinarySmilSearch&);
+
     SmilTreeBuilder* buildTree(int id);
+    bool buildCurrentTree();
 
     int upperSmilIdx;
     int currentSmilIdx;
     int lowerSmilIdx;
 
     SmilTreeBuilder currentTreeBuilder;
-    SmilTree currentSmilTree;
+    SmilTree* currentSmilTree; // A new tree for each file, trees can not be copied
+    bool currentSmilTreeBuilt; // Only the head is read until the tree is needed
     std::string currentSmilPath; // Extract from here if necessary.
 };
 
@@ -25,6 +25,7 @@
 
 //PROJECT INCLUDES
 #include "ContentNode.h"
+#include "NodeArena.h"
 #include "SmilTree.h"
 
 using namespace std;
@@ -42,16 +43,12 @@ ContentNode::ContentNode()
 
 //--------------------------------------------------
 /*!
- destructor deallocates mpMediaData
+ the media data is owned by the node arena of the tree, not by this node
  */
 //--------------------------------------------------
 ContentNode::~ContentNode()
 {
-    if (mNodeType != NONE)
-    {
-        delete mpMediaData;
-
-    }
+    //empty function
 }
 
 //--------------------------------------------------
@@ -76,36 +73,36 @@ NodeType ContentNode::getTypeOfNode()
 
 //--------------------------------------------------
 /*
- create mpMediaData as a new audio node
+ create mpMediaData as a new audio node in the arena of the tree
  */
 //--------------------------------------------------
-void ContentNode::createNewAudio()
+void ContentNode::createNewAudio(NodeArena* pArena)
 {
-    mpMediaData = new amis::AudioNode();
+    mpMediaData = pArena->create<amis::AudioNode>();
     mNodeType = AUD;
 
 }
 
 //--------------------------------------------------
 /*
- create mpMediaData as a new image node
+ create mpMediaData as a new image node in the arena of the tree
  */
 //--------------------------------------------------
-void ContentNode::createNewImage()
+void ContentNode::createNewImage(NodeArena* pArena)
 {
-    mpMediaData = new amis::ImageNode();
+    mpMediaData = pArena->create<amis::ImageNode>();
     mNodeType = IMG;
 
 }
 
 //--------------------------------------------------
 /*
- create mpMediaData as a new text node
+ create mpMediaData as a new text node in the arena of the tree
  */
 //--------------------------------------------------
-void ContentNode::createNewText()
+void ContentNode::createNewText(NodeArena* pArena)
 {
-    mpMediaData = new amis::TextNode();
+    mpMediaData = pArena->create<amis::TextNode>();
     mNodeType = TXT;
 
 }
@@ -28,6 +28,8 @@
 #include "Node.h"
 #include "SmilMediaGroup.h"
 
+class NodeArena;
+
 //! ContentNode represents any media reference in a SMIL file
 /*!
  the media data itself is represented by an amis::MediaNode member variable.
@@ -51,11 +53,11 @@ public:
 
     //ACCESS
     //!create the media node as a new audio node
-    void createNewAudio();
+    void createNewAudio(NodeArena*);
     //!create the media node as a new image node
-    void createNewImage();
+    void createNewImage(NodeArena*);
     //!create the media node as a new text node
-    void createNewText();
+    void createNewText(NodeArena*);
     //!play this node
     void play(amis::SmilMediaGroup*);
 
@@ -40,6 +40,7 @@ Node::Node()
     mElementId = "";
     mpSibling = NULL;
     mpParent = NULL;
+    mIndexInParent = 0;
     mpSmilTree = NULL;
 }
 
@@ -118,6 +119,22 @@ TimeContainerNode* Node::getParent()
     return mpParent;
 }
 
+//--------------------------------------------------
+// Set the position of this node among its parent's children
+//--------------------------------------------------
+void Node::setIndexInParent(int index)
+{
+    mIndexInParent = index;
+}
+
+//--------------------------------------------------
+// Get the position of this node among its parent's children
+//--------------------------------------------------
+int Node::getIndexInParent()
+{
+    return mIndexInParent;
+}
+
 //--------------------------------------------------
 //Geturn a pointer to this node's sibling
 /*!
@@ -61,6 +61,10 @@ public:
     void setParent(TimeContainerNode*);
     //!return this node's parent
     TimeContainerNode* getParent();
+    //!set the position of this node among its parent's children
+    void setIndexInParent(int);
+    //!get the position of this node among its parent's children
+    int getIndexInParent();
 
     //!set the smil tree pointer
     void setSmilTreePtr(SmilTree*);
@@ -88,6 +92,8 @@ private:
     Node* mpSibling;
     //!parent node pointer
     TimeContainerNode* mpParent;
+    //!position among the parent's children
+    int mIndexInParent;
     //!smil tree pointer
     SmilTree* mpSmilTree;
     //!element id string
@@ -0,0 +1,186 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+//SYSTEM INCLUDES
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+//PROJECT INCLUDES
+#include "SmilEngineConstants.h"
+#include "NodeArena.h"
+
+using namespace std;
+
+//!objects start at a multiple of the strictest alignment of their members
+union MaxAlign
+{
+    void* mpPointer;
+    long mLong;
+    double mDouble;
+};
+
+//--------------------------------------------------
+//Default constructor
+//--------------------------------------------------
+NodeArena::NodeArena()
+{
+    mNumObjects = 0;
+    mMemoryUsage = 0;
+    mNextBlockSize = ARENA_BLOCK_SIZE;
+    mBlockSize = ARENA_BLOCK_SIZE;
+}
+
+//--------------------------------------------------
+//Destructor
+//--------------------------------------------------
+NodeArena::~NodeArena()
+{
+    clear();
+}
+
+//--------------------------------------------------
+/*!
+ Destroy the objects block by block, each object is found after the one
+ before it by the size in its header.
+ */
+//--------------------------------------------------
+void NodeArena::clear()
+{
+    size_t header_size = align(sizeof(const ObjectType*));
+
+    for (unsigned int i = 0; i < mBlocks.size(); i++)
+    {
+        size_t offset = 0;
+        while (offset < mBlocks[i].mUsed)
+        {
+            const ObjectType* p_type =
+                    *(const ObjectType**) (mBlocks[i].mpData + offset);
+            p_type->mpDestroy(mBlocks[i].mpData + offset + header_size);
+            offset += header_size + align(p_type->mSize);
+        }
+        free(mBlocks[i].mpData);
+    }
+
+    mBlocks.clear();
+    mNumObjects = 0;
+    mMemoryUsage = 0;
+    mNextBlockSize = ARENA_BLOCK_SIZE;
+    mBlockSize = ARENA_BLOCK_SIZE;
+}
+
+//--------------------------------------------------
+/*!
+ Most trees are small, so a fixed block size leaves a large part of the
+ last block empty. With the expected size the next block holds the whole
+ tree, and a tree that turns out larger continues in blocks an eighth of
+ that size.
+ @param[in] bytes
+ the expected size of the objects, 0 goes back to ARENA_BLOCK_SIZE blocks
+ */
+//--------------------------------------------------
+void NodeArena::setExpectedSize(size_t bytes)
+{
+    if (bytes == 0)
+    {
+        mNextBlockSize = ARENA_BLOCK_SIZE;
+        mBlockSize = ARENA_BLOCK_SIZE;
+        return;
+    }
+
+    mNextBlockSize = bytes;
+    mBlockSize = bytes / 8;
+    if (mNextBlockSize < ARENA_MIN_BLOCK_SIZE)
+        mNextBlockSize = ARENA_MIN_BLOCK_SIZE;
+    if (mBlockSize < ARENA_MIN_BLOCK_SIZE)
+        mBlockSize = ARENA_MIN_BLOCK_SIZE;
+}
+
+//--------------------------------------------------
+//get the number of objects in the arena
+//--------------------------------------------------
+unsigned long NodeArena::getNumberOfObjects()
+{
+    return mNumObjects;
+}
+
+//--------------------------------------------------
+//get the bytes taken from the heap for the blocks
+//--------------------------------------------------
+unsigned long NodeArena::getMemoryUsage()
+{
+    return mMemoryUsage;
+}
+
+//--------------------------------------------------
+/*!
+ Make room for an object and its header at the end of the last block,
+ starting a new block if it does not fit.
+ @return where the object goes
+ */
+//--------------------------------------------------
+void* NodeArena::reserve(size_t size)
+{
+    size_t header_size = align(sizeof(const ObjectType*));
+    size_t needed = header_size + align(size);
+
+    if (mBlocks.size() == 0
+            || mBlocks.back().mSize - mBlocks.back().mUsed < needed)
+    {
+        //the space left in the last block is not used
+        Block block;
+        block.mSize = mNextBlockSize;
+        if (block.mSize < needed)
+            block.mSize = needed;
+        mNextBlockSize = mBlockSize;
+
+        block.mpData = (char*) malloc(block.mSize);
+        if (block.mpData == NULL)
+            throw std::bad_alloc();
+        block.mUsed = 0;
+
+        mBlocks.push_back(block);
+        mMemoryUsage += block.mSize;
+    }
+
+    return mBlocks.back().mpData + mBlocks.back().mUsed + header_size;
+}
+
+//--------------------------------------------------
+/*!
+ Write the header of the object last reserved, from here on it is destroyed
+ with the arena.
+ */
+//--------------------------------------------------
+void NodeArena::commit(const ObjectType* pType)
+{
+    Block& block = mBlocks.back();
+    *(const ObjectType**) (block.mpData + block.mUsed) = pType;
+    block.mUsed += align(sizeof(const ObjectType*)) + align(pType->mSize);
+    mNumObjects++;
+}
+
+//--------------------------------------------------
+//round a size up to the object alignment
+//--------------------------------------------------
+size_t NodeArena::align(size_t size)
+{
+    return (size + sizeof(MaxAlign) - 1) / sizeof(MaxAlign) * sizeof(MaxAlign);
+}
@@ -0,0 +1,132 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef NODEARENA_H
+#define NODEARENA_H
+
+//SYSTEM INCLUDES
+#include <cstddef>
+#include <new>
+#include <vector>
+
+//! The Node Arena owns the nodes and media objects of one smil tree
+/*!
+ Objects are placed one after another in large blocks, so building a tree
+ takes a heap allocation per block instead of one per node. Each object is
+ preceded by a pointer to the destructor and size of its type.
+
+ The blocks are ARENA_BLOCK_SIZE bytes unless the expected size of the tree
+ is given with setExpectedSize(), then the first block holds all of it and
+ the blocks after it an eighth of that.
+
+ Objects are never freed on their own, they must not delete each other.
+ clear() runs the destructors of all objects in the order they were created
+ and frees the blocks.
+ */
+class NodeArena
+{
+
+public:
+    //LIFECYCLE
+    //!default constructor
+    NodeArena();
+    //!destructor, clears the arena
+    ~NodeArena();
+
+    //METHODS
+    //!create an object with its default constructor
+    template<class T> T* create()
+    {
+        T* p_object = new (reserve(sizeof(T))) T();
+        commit(&TypeInfo<T>::sType);
+        return p_object;
+    }
+    //!destroy all objects and free the blocks
+    void clear();
+    //!size the next blocks for a tree of about this many bytes
+    void setExpectedSize(size_t);
+
+    //ACCESS
+    //!get the number of objects in the arena
+    unsigned long getNumberOfObjects();
+    //!get the bytes taken from the heap for the blocks
+    unsigned long getMemoryUsage();
+
+private:
+    //!not copyable, the blocks and objects are owned by one arena
+    NodeArena(const NodeArena&);
+    //!not copyable, the blocks and objects are owned by one arena
+    NodeArena& operator=(const NodeArena&);
+
+    //!how to destroy an object of a type and step over it
+    struct ObjectType
+    {
+        //!run the destructor of an object
+        void (*mpDestroy)(void*);
+        //!size of the object
+        size_t mSize;
+    };
+
+    //!the object type of a class
+    template<class T> struct TypeInfo
+    {
+        static void destroy(void* pObject)
+        {
+            static_cast<T*>(pObject)->~T();
+        }
+        static const ObjectType sType;
+    };
+
+    //!a block of objects
+    struct Block
+    {
+        //!the memory of the block
+        char* mpData;
+        //!bytes used from the start of the block
+        size_t mUsed;
+        //!size of the block
+        size_t mSize;
+    };
+
+    //METHODS
+    //!get memory for an object, it is not kept until it is committed
+    void* reserve(size_t);
+    //!keep the object last reserved
+    void commit(const ObjectType*);
+    //!round a size up to the object alignment
+    static size_t align(size_t);
+
+    //MEMBER VARIABLES
+    //!the blocks, objects are added to the last one
+    std::vector<Block> mBlocks;
+    //!number of objects
+    unsigned long mNumObjects;
+    //!bytes taken from the heap
+    unsigned long mMemoryUsage;
+    //!size of the next block
+    size_t mNextBlockSize;
+    //!size of the blocks after the next one
+    size_t mBlockSize;
+};
+
+template<class T> const NodeArena::ObjectType NodeArena::TypeInfo<T>::sType =
+{ &NodeArena::TypeInfo<T>::destroy, sizeof(T) };
+
+#endif
@@ -44,7 +44,7 @@ using namespace std;
 //--------------------------------------------------
 NodeBuilder::NodeBuilder()
 {
-    //Empty
+    mpArena = NULL;
 }
 
 //--------------------------------------------------
@@ -63,6 +63,14 @@ void NodeBuilder::setSourceSmilPath(string smilFilePath)
     mSmilPath = smilFilePath;
 }
 
+//--------------------------------------------------
+//set the arena of the tree being built, the arena owns the new nodes
+//--------------------------------------------------
+void NodeBuilder::setArena(NodeArena* pArena)
+{
+    mpArena = pArena;
+}
+
 //--------------------------------------------------
 /*!
  Create a node from XML element data.
@@ -140,7 +148,7 @@ Node* NodeBuilder::createSeqNode()
     string attribute_value;
 
     //pointer to a new seq node
-    SeqNode* p_seq = new SeqNode();
+    SeqNode* p_seq = mpArena->create<SeqNode>();
 
     //get and save the Id
     const char* id = NULL;
@@ -194,7 +202,7 @@ Node* NodeBuilder::createParNode()
     string attribute_value;
 
     //pointer to a new par node
-    ParNode* p_par = new ParNode();
+    ParNode* p_par = mpArena->create<ParNode>();
 
     //get and save the Id
     const char* id = NULL;
@@ -287,8 +295,8 @@ Node* NodeBuilder::createAudioNode()
     string attribute_value;
 
     //create a new audio node
-    ContentNode* p_audio = new ContentNode();
-    p_audio->createNewAudio();
+    ContentNode* p_audio = mpArena->create<ContentNode>();
+    p_audio->createNewAudio(mpArena);
 
     amis::AudioNode* p_audioMedia = (amis::AudioNode*) p_audio->getMediaNode();
 
@@ -432,8 +440,8 @@ Node* NodeBuilder::createTextNode()
     string attribute_value;
 
     //create a new text node
-    ContentNode* p_text = new ContentNode();
-    p_text->createNewText();
+    ContentNode* p_text = mpArena->create<ContentNode>();
+    p_text->createNewText(mpArena);
 
     amis::TextNode* p_textMedia = (amis::TextNode*) p_text->getMediaNode();
 
@@ -523,8 +531,8 @@ Node* NodeBuilder::createImageNode()
     string attribute_value;
 
     //create a new image node
-    ContentNode* p_image = new ContentNode();
-    p_image->createNewImage();
+    ContentNode* p_image = mpArena->create<ContentNode>();
+    p_image->createNewImage(mpArena);
 
     amis::ImageNode* p_imageMedia = (amis::ImageNode*) p_image->getMediaNode();
 
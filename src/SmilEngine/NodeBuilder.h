@@ -28,6 +28,7 @@
 //PROJECT INCLUDES
 #include "SmilEngineConstants.h"
 #include "Node.h"
+#include "NodeArena.h"
 
 #include <XmlReader.h>
 #include <XmlAttributes.h>
@@ -56,6 +57,8 @@ public:
     //ACCESS
     //!set the smil file source path
     void setSourceSmilPath(std::string);
+    //!set the arena that the nodes are created in
+    void setArena(NodeArena*);
 
 private:
 
@@ -78,6 +81,8 @@ private:
     const XmlAttributes* mpAttributes;
     //!path to the smil file being parsed by SmilTreeBuilder
     std::string mSmilPath;
+    //!arena of the tree being built
+    NodeArena* mpArena;
 };
 
 #endif
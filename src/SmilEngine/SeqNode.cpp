@@ -92,6 +92,14 @@ void SeqNode::setChildIndex(int index)
     mActiveChildIndex = index;
 }
 
+//--------------------------------------------------
+//get the index of the active child
+//--------------------------------------------------
+int SeqNode::getChildIndex()
+{
+    return mActiveChildIndex;
+}
+
 //--------------------------------------------------
 /*!
  this function increments the active child index on the 
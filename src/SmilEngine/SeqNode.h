@@ -60,6 +60,8 @@ public:
 
     //!set this node's child index
     void setChildIndex(int);
+    //!get this node's child index
+    int getChildIndex();
 
 private:
     //!index of the active child in this node's child node collection
@@ -56,6 +56,9 @@
 #include "SpineBuilder.h"
 #include "SmilTreeBuilder.h"
 #include "SmilTree.h"
+#include "SmilTimeIndex.h"
+#include "SmilTreeCache.h"
+#include "SmilTreePrefetcher.h"
 #include "SmilEngine.h"
 
 #ifdef WIN32
@@ -96,6 +99,11 @@ SmilEngine::SmilEngine():
     //initialize member variables
     mSpineBuilder = new SpineBuilder();
     mSmilTreeBuilder = new SmilTreeBuilder();
+    mpTimeIndex = new SmilTimeIndex();
+    mpTreeCache = new SmilTreeCache();
+    mpPrefetcher = new SmilTreePrefetcher(mpTreeCache);
+    mbPrefetchNext = true;
+    mbPrefetchPrevious = false;
     //pointers are NULL
     mpSpine = NULL;
     mpSmilTree = NULL;
@@ -107,6 +115,9 @@ SmilEngine::SmilEngine():
     //we are not at the end of a Smil Tree
     mbEndOfTree = false;
     mbLoadId = false;
+    mbLoadTime = false;
+    mTimeTarget = 0;
+    mTimeOffset = 0;
 
     mSpineBuildStatus = amis::NOT_INITIALIZED;
     mSmilTreeBuildStatus = amis::NOT_INITIALIZED;
@@ -124,6 +135,9 @@ SmilEngine::~SmilEngine()
     mLastPosition = "";
     delete(mSpineBuilder);
     delete(mSmilTreeBuilder);
+    delete(mpTimeIndex);
+    delete(mpPrefetcher);
+    delete(mpTreeCache);
 }
 
 /**
@@ -203,6 +217,9 @@ if(    file_ext.compare(EXT_OPF) == 0)
  */
 void SmilEngine::closeBook()
 {
+    //the worker must be done with the book before it goes away
+    mpPrefetcher->stop();
+
     if (mSpineBuildStatus != amis::NOT_INITIALIZED)
     {
         LOG4CXX_DEBUG(amisSmilEngineLog, "deleting spine");
@@ -217,8 +234,14 @@ void SmilEngine::closeBook()
         mpSmilTree = NULL;
     }
 
+    delete mpOldSmilTree;
+    mpOldSmilTree = NULL;
+    mpTreeCache->clear();
+
     clearAllSkipOptions();
 
+    mpTimeIndex->clear();
+
     mSpineBuildStatus = amis::NOT_INITIALIZED;
     mSmilTreeBuildStatus = amis::NOT_INITIALIZED;
 
@@ -234,24 +257,61 @@ void SmilEngine::closeBook()
 amis::AmisError SmilEngine::createTreeFromFile(std::string filepath,
         SmilMediaGroup* pMedia)
 {
-    //local variables
+    amis::AmisError err;
+    SmilTree* p_cached = NULL;
 
-    if (mpSmilTree != NULL)
+    //the current tree can be used again if it is for the same file
+    if (mpSmilTree != NULL && mSmilTreeBuildStatus == amis::OK
+            && mpSmilTree->getSmilFilePath().compare(filepath) == 0)
+    {
+        LOG4CXX_DEBUG(amisSmilEngineLog, "reusing tree for " << filepath);
+    }
+    else
     {
+        //the previous tree goes to the cache, it may be the one we want
         if (mpOldSmilTree != NULL)
-            delete mpOldSmilTree;
-        mpOldSmilTree = mpSmilTree;
+        {
+            mpTreeCache->put(mpOldSmilTree);
+            mpOldSmilTree = NULL;
+        }
+
+        //wait if the file is being prefetched right now
+        mpPrefetcher->release(filepath);
+        p_cached = mpTreeCache->take(filepath);
+
+        if (mpSmilTree != NULL)
+        {
+            //keep the last known good tree, a failed one is not worth caching
+            if (mSmilTreeBuildStatus == amis::OK)
+            {
+                mpOldSmilTree = mpSmilTree;
+            }
+            else
+            {
+                delete mpSmilTree;
+            }
+            mpSmilTree = NULL;
+        }
     }
 
-    //make a new smil tree for this book
-    mpSmilTree = new SmilTree();
+    if (p_cached != NULL)
+    {
+        LOG4CXX_DEBUG(amisSmilEngineLog, "using cached tree for " << filepath);
+        mpSmilTree = p_cached;
+        mSmilTreeBuildStatus = amis::OK;
+    }
+    else if (mpSmilTree == NULL)
+    {
+        //make a new smil tree for this book
+        mpSmilTree = new SmilTree();
 
-    //build a smil tree from the selected Smil file
-    LOG4CXX_DEBUG(amisSmilEngineLog, "opening " << filepath);
-    mSmilTreeBuilder->setDaisyVersion(mDaisyVersion);
-    amis::AmisError err = mSmilTreeBuilder->createSmilTree(mpSmilTree, filepath);
+        //build a smil tree from the selected Smil file
+        LOG4CXX_DEBUG(amisSmilEngineLog, "opening " << filepath);
+        mSmilTreeBuilder->setDaisyVersion(mDaisyVersion);
+        err = mSmilTreeBuilder->createSmilTree(mpSmilTree, filepath);
 
-    mSmilTreeBuildStatus = err.getCode();
+        mSmilTreeBuildStatus = err.getCode();
+    }
 
     // Recover the old tree if we failed to load the new one
     if (mSmilTreeBuildStatus != amis::OK)
@@ -261,6 +321,7 @@ amis::AmisError SmilEngine::createTreeFromFile(std::string filepath,
 
             LOG4CXX_WARN(amisSmilEngineLog, "Recovering old tree");
             mSmilTreeBuildStatus = amis::OK;
+            delete mpSmilTree;
             mpSmilTree = mpOldSmilTree;
             mpOldSmilTree = NULL;
             return err;
@@ -286,6 +347,9 @@ amis::AmisError SmilEngine::createTreeFromFile(std::string filepath,
     LOG4CXX_DEBUG(amisSmilEngineLog, "Setting skip options");
     mpSmilTree->setSkipOptionList(&mSkipOptions);
 
+    //get the neighbouring files ready while this one plays
+    prefetchNeighbours();
+
     //are we going to a specific element ID?
     if (mbLoadId == true)
     {
@@ -294,6 +358,22 @@ amis::AmisError SmilEngine::createTreeFromFile(std::string filepath,
         err = mpSmilTree->goToId(mIdTarget, pMedia);
     }
 
+    //are we going to a time in the file?
+    else if (mbLoadTime == true)
+    {
+        LOG4CXX_DEBUG(amisSmilEngineLog, "Loading time " << mTimeTarget);
+        mbLoadTime = false;
+        err = mpSmilTree->goToTime(mTimeTarget, pMedia, mTimeOffset);
+
+        //a file without audio is played from the top
+        if (err.getCode() == amis::NOT_FOUND)
+        {
+            LOG4CXX_DEBUG(amisSmilEngineLog, "Going to first node");
+            mTimeOffset = 0;
+            err = mpSmilTree->goFirst(pMedia);
+        }
+    }
+
     else
     {
         //if we should NOT go to the end of the tree (if we are entering the tree from the top)
@@ -784,6 +864,106 @@ amis::AmisError SmilEngine::loadPosition(std::string positionUri,
 
 }
 
+/**
+ * go to the group holding an audio clip in the current smil file.
+ *
+ * @param[in] audioId
+ * id of the audio element
+ *
+ * @param[out] pMedia
+ * playback data for the group is stored here
+ *
+ * @return amis::OK if the clip was found. A clip inside a skipped structure
+ * goes on to the next group that is played, like next() does
+ */
+amis::AmisError SmilEngine::goToAudioId(std::string audioId,
+        SmilMediaGroup* pMedia)
+{
+    amis::AmisError err;
+    err.setSourceModuleName(amis::module_SmilEngine);
+
+    if (mpSmilTree == NULL || mSmilTreeBuildStatus != amis::OK)
+    {
+        err.setCode(amis::NOT_INITIALIZED);
+        return err;
+    }
+
+    LOG4CXX_DEBUG(amisSmilEngineLog, "going to audio clip " << audioId);
+    err = mpSmilTree->goToAudioId(audioId, pMedia);
+
+    //the clip was skipped and nothing after it in this file is played
+    if (err.getCode() == amis::AT_END)
+        return next(pMedia);
+
+    if (err.getCode() == amis::OK)
+    {
+        recordPosition();
+    }
+
+    return err;
+}
+
+/**
+ * go to the audio clip playing at a time in a smil file, without stepping
+ * through the clips before it.
+ *
+ * @param[in] smilPath
+ * full path to the smil file
+ *
+ * @param[in] ms
+ * time from the start of the smil file in milliseconds
+ *
+ * @param[out] pMedia
+ * playback data for the clip is stored here
+ *
+ * @param[out] clipOffset
+ * time from the start of the clip in milliseconds
+ *
+ * @param[out] textIds
+ * ids of the text elements before the clip, in document order
+ *
+ * @return amis::OK if loading of the time succeeded
+ */
+amis::AmisError SmilEngine::loadTime(std::string smilPath, unsigned long ms,
+        SmilMediaGroup* pMedia, unsigned long& clipOffset,
+        std::vector<std::string>& textIds)
+{
+    amis::AmisError err;
+    err.setSourceModuleName(amis::module_SmilEngine);
+
+    LOG4CXX_DEBUG(amisSmilEngineLog, "loading " << ms << " ms in " << smilPath);
+
+    clipOffset = 0;
+    textIds.clear();
+
+    smilPath = amis::FilePathTools::clearTarget(smilPath);
+
+    if (mpSpine->goToFile(smilPath) == false)
+    {
+        err.setCode(amis::NOT_FOUND);
+        err.setMessage("*" + smilPath + "* was not found.");
+        return err;
+    }
+
+    //we are not at the end of the tree
+    mbEndOfTree = false;
+    mbLoadTime = true;
+    mTimeTarget = ms;
+    mTimeOffset = 0;
+
+    err = createTreeFromFile(smilPath, pMedia);
+    mbLoadTime = false;
+
+    if (err.getCode() == amis::OK)
+    {
+        clipOffset = mTimeOffset;
+        mpSmilTree->getTextIdsBefore(ms, textIds);
+        recordPosition();
+    }
+
+    return err;
+}
+
 
 /**
  * Record our current position
@@ -836,10 +1016,10 @@ string SmilEngine::getSmilSourcePath()
  */
 std::string SmilEngine::getMetadata(std::string metaname)
 {
-    if (mSmilTreeBuildStatus != amis::OK)
+    if (mSmilTreeBuildStatus != amis::OK || mpSmilTree == NULL)
         return "";
 
-    return mSmilTreeBuilder->getMetadata(metaname);
+    return mpSmilTree->getMetadata(metaname);
 }
 
 /**
@@ -852,6 +1032,192 @@ int SmilEngine::getDaisyVersion()
     return mDaisyVersion;
 }
 
+/**
+ * Build the time index for the open book
+ *
+ * May run on a worker thread while the book plays, the spine is only read.
+ *
+ * @param pProgress Called with the number of indexed files, the total and pProgressData, may be NULL
+ * @param pProgressData Passed to pProgress
+ * @return amis::OK if every smil file in the spine was indexed
+ */
+amis::AmisError SmilEngine::buildTimeIndex(
+        void (*pProgress)(unsigned int, unsigned int, void*),
+        void* pProgressData)
+{
+    amis::AmisError err;
+
+    if (mSpineBuildStatus != amis::OK)
+    {
+        err.setCode(amis::NOT_INITIALIZED);
+        err.setMessage(MSG_BOOK_NOT_OPEN);
+        err.setSourceModuleName(amis::module_SmilEngine);
+        return err;
+    }
+
+    return mpTimeIndex->build(mpSpine, mDaisyVersion, pProgress,
+            pProgressData);
+}
+
+/**
+ * Get the time index
+ *
+ * @return Returns the time index for the open book, check isReady() before use
+ */
+SmilTimeIndex* SmilEngine::getTimeIndex()
+{
+    return mpTimeIndex;
+}
+
+/**
+ * Build the trees for the files next to the current one on a worker thread
+ */
+void SmilEngine::prefetchNeighbours()
+{
+    unsigned int idx = mpSpine->getCurrentIndex();
+    string smil_path;
+
+    if (mbPrefetchNext == true
+            && idx + 1 < (unsigned int) mpSpine->getNumberOfSmilFiles())
+    {
+        smil_path = mpSpine->getSmilFilePath(idx + 1);
+        if (mpOldSmilTree == NULL
+                || mpOldSmilTree->getSmilFilePath().compare(smil_path) != 0)
+        {
+            mpPrefetcher->request(smil_path, mDaisyVersion);
+        }
+    }
+
+    if (mbPrefetchPrevious == true && idx > 0)
+    {
+        smil_path = mpSpine->getSmilFilePath(idx - 1);
+        if (mpOldSmilTree == NULL
+                || mpOldSmilTree->getSmilFilePath().compare(smil_path) != 0)
+        {
+            mpPrefetcher->request(smil_path, mDaisyVersion);
+        }
+    }
+}
+
+/**
+ * Enable or disable building the next smil file ahead of playback
+ *
+ * @param enable True to prefetch the next file, on by default
+ */
+void SmilEngine::setPrefetchNext(bool enable)
+{
+    mbPrefetchNext = enable;
+}
+
+/**
+ * Enable or disable building the previous smil file ahead of playback
+ *
+ * @param enable True to prefetch the previous file, off by default
+ */
+void SmilEngine::setPrefetchPrevious(bool enable)
+{
+    mbPrefetchPrevious = enable;
+}
+
+/**
+ * Get the smil tree prefetcher
+ *
+ * @return Returns the prefetcher that fills the smil tree cache
+ */
+SmilTreePrefetcher* SmilEngine::getPrefetcher()
+{
+    return mpPrefetcher;
+}
+
+/**
+ * Get the audio clips playback will reach after the current group
+ *
+ * The clips come in the order next() would play them, skipped structures
+ * are left out and the lookahead continues into the following smil files of
+ * the spine. At most PLAYLIST_MAX_FILES files are looked at. A file whose
+ * tree is not cached is not parsed here, it is handed to the prefetcher and
+ * the playlist stops before it, asking again once the tree is built gives
+ * the rest. Neither the current tree nor the spine is moved.
+ *
+ * @param count The number of clips wanted
+ * @param clips Filled with the clips, fewer than count near the end of the
+ * book or while the tree of a following file is being built
+ * @return amis::OK if the clips were collected
+ */
+amis::AmisError SmilEngine::getPlaylist(unsigned int count,
+        vector<PlaylistClip>& clips)
+{
+    amis::AmisError err;
+    err.setSourceModuleName(amis::module_SmilEngine);
+
+    clips.clear();
+
+    if (mSpineBuildStatus != amis::OK || mSmilTreeBuildStatus != amis::OK)
+    {
+        err.setCode(amis::NOT_INITIALIZED);
+        err.setMessage(MSG_BOOK_NOT_OPEN);
+        return err;
+    }
+
+    mpSmilTree->getClipsAfterCurrent(count, clips);
+
+    unsigned int idx = mpSpine->getCurrentIndex();
+    unsigned int num_files = mpSpine->getNumberOfSmilFiles();
+
+    for (unsigned int i = idx + 1;
+            i < num_files && i <= idx + PLAYLIST_MAX_FILES
+                    && clips.size() < count; i++)
+    {
+        string smil_path = mpSpine->getSmilFilePath(i);
+        SmilTree* p_tree = NULL;
+        bool b_cache_tree = false;
+
+        //the current and the last tree are not kept in the cache
+        if (mpSmilTree->getSmilFilePath().compare(smil_path) == 0)
+        {
+            p_tree = mpSmilTree;
+        }
+        else if (mpOldSmilTree != NULL
+                && mpOldSmilTree->getSmilFilePath().compare(smil_path) == 0)
+        {
+            p_tree = mpOldSmilTree;
+        }
+        else
+        {
+            //the prefetcher is not waited for, the caller may be holding up
+            //playback
+            p_tree = mpTreeCache->take(smil_path);
+            b_cache_tree = true;
+        }
+
+        if (p_tree == NULL)
+        {
+            LOG4CXX_DEBUG(amisSmilEngineLog, "Playlist waits for " << smil_path);
+            mpPrefetcher->request(smil_path, mDaisyVersion);
+            break;
+        }
+
+        p_tree->setSkipOptionList(&mSkipOptions);
+        p_tree->getClipsFromStart(count, clips);
+
+        if (b_cache_tree == true)
+            mpTreeCache->put(p_tree);
+    }
+
+    err.setCode(amis::OK);
+    return err;
+}
+
+/**
+ * Get the smil tree cache
+ *
+ * @return Returns the cache of recently used smil trees
+ */
+SmilTreeCache* SmilEngine::getTreeCache()
+{
+    return mpTreeCache;
+}
+
 /**
  * Get smil file path
  *
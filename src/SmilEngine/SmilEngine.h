@@ -25,10 +25,12 @@
 
 //SYSTEM INCLUDES
 #include <string>
+#include <vector>
 
 //PROJECT INCLUDES
 #include "AmisError.h"
 #include "SmilMediaGroup.h"
+#include "SmilEngineConstants.h"
 #include <string>
 
 #ifdef WIN32
@@ -56,6 +58,9 @@
 class SpineBuilder;
 class SmilTreeBuilder;
 class SmilTree;
+class SmilTimeIndex;
+class SmilTreeCache;
+class SmilTreePrefetcher;
 class Spine;
 class CustomTest;
 
@@ -96,6 +101,11 @@ public:
     amis::AmisError escapeCurrent(SmilMediaGroup*);
     //!load a specific position
     amis::AmisError loadPosition(std::string, SmilMediaGroup*);
+    //!go to an audio clip in the current smil file
+    amis::AmisError goToAudioId(std::string, SmilMediaGroup*);
+    //!load the audio clip playing at a time in a smil file
+    amis::AmisError loadTime(std::string, unsigned long, SmilMediaGroup*,
+            unsigned long&, std::vector<std::string>&);
     //!change a skippability option
     bool changeSkipOption(std::string, bool);
     //!get the number of SMIL files
@@ -112,6 +122,23 @@ public:
     //!return daisy version for open book
     int getDaisyVersion();
 
+    //!build the time index for the open book
+    amis::AmisError buildTimeIndex(
+            void (*pProgress)(unsigned int, unsigned int, void*) = NULL,
+            void* pProgressData = NULL);
+    //!get the time index for the open book
+    SmilTimeIndex* getTimeIndex();
+    //!get the cache of recently used smil trees
+    SmilTreeCache* getTreeCache();
+    //!prefetch the next smil file while the current one plays
+    void setPrefetchNext(bool);
+    //!prefetch the previous smil file while the current one plays
+    void setPrefetchPrevious(bool);
+    //!get the smil tree prefetcher
+    SmilTreePrefetcher* getPrefetcher();
+    //!get the audio clips after the current group without moving
+    amis::AmisError getPlaylist(unsigned int, std::vector<PlaylistClip>&);
+
     void printTree();
 
 private:
@@ -123,6 +150,8 @@ private:
     amis::AmisError createTreeFromFile(std::string, SmilMediaGroup*);
     //!clear all skippability options
     void clearAllSkipOptions();
+    //!request the files next to the current one from the prefetcher
+    void prefetchNeighbours();
 
     //MEMBER VARIABLES
     //!the spine builder
@@ -136,6 +165,16 @@ private:
     SmilTree *mpOldSmilTree;
     //!the spine
     Spine* mpSpine;
+    //!the time index
+    SmilTimeIndex* mpTimeIndex;
+    //!recently used smil trees
+    SmilTreeCache* mpTreeCache;
+    //!builds trees ahead of playback
+    SmilTreePrefetcher* mpPrefetcher;
+    //!prefetch the next file flag
+    bool mbPrefetchNext;
+    //!prefetch the previous file flag
+    bool mbPrefetchPrevious;
 
     //!a list of skippability options
     std::vector<amis::CustomTest*> mSkipOptions;
@@ -149,6 +188,8 @@ private:
     bool mbEndOfTree;
     //!load id flag
     bool mbLoadId;
+    //!load time flag
+    bool mbLoadTime;
 
     //!path to the book's spine file
     std::string mBookFile;
@@ -159,6 +200,10 @@ private:
     std::string mLastPosition;
     //!target to seek until
     std::string mIdTarget;
+    //!time to seek to in milliseconds
+    unsigned long mTimeTarget;
+    //!time from the start of the clip found by the last time seek
+    unsigned long mTimeOffset;
 
     //singleton instance
     static SmilEngine* pinstance;
@@ -52,6 +52,8 @@
 #define	TAG_TXT					"text"
 #define	TAG_SEQ					"seq"
 #define TAG_META				"meta"
+#define TAG_HEAD				"head"
+#define TAG_BODY				"body"
 #define TAG_REGION				"region"
 #define TAG_CUSTOM_TEST			"customTest"
 #define TAG_MANIFEST			"manifest"
@@ -88,6 +90,20 @@
 #define VAL_HIDDEN				"hidden"
 #define VAL_APP_SMIL			"application/smil"
 
+//smil tree cache defaults
+#define CACHE_MAX_TREES			4
+#define CACHE_MAX_MEMORY		(4 * 1024 * 1024)
+
+//smil tree node arena block size, most smil files hold only a few pars
+#define ARENA_BLOCK_SIZE		2048
+//smallest arena block when the blocks are sized to the smil file
+#define ARENA_MIN_BLOCK_SIZE	512
+//arena bytes expected per byte of smil file, most files take 2 to 3
+#define ARENA_BYTES_PER_SMIL_BYTE	2
+
+//number of smil files a playlist lookahead may open after the current one
+#define PLAYLIST_MAX_FILES		4
+
 //return messages
 #define MSG_BOOK_NOT_OPEN		"Book_Not_Open"
 #define MSG_BEGINNING_OF_BOOK	"Beginning_Of_Book"
@@ -113,5 +129,24 @@ struct ContentRegionData
 	std::string mId;
     std::string mXmlString;
 };
+
+//! an audio clip in the order playback will reach it
+struct PlaylistClip
+{
+    //!path of the smil file holding the clip
+    std::string mSmilFile;
+    //!id of the group the clip plays in, empty if the group has no id
+    std::string mGroupId;
+    //!id of the audio element
+    std::string mAudioId;
+    //!id of the text played with the clip, empty if there is none
+    std::string mTextId;
+    //!audio file as written in the smil file
+    std::string mSrc;
+    //!clip begin in milliseconds, -1 if it could not be parsed
+    long mClipBeginMs;
+    //!clip end in milliseconds, -1 if it could not be parsed
+    long mClipEndMs;
+};
 //end of file
 #endif
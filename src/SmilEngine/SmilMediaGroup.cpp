@@ -49,6 +49,8 @@ using namespace amis;
 //--------------------------------------------------
 SmilMediaGroup::SmilMediaGroup()
 {
+    mbEscape = false;
+    mbPause = false;
 }
 
 //--------------------------------------------------
@@ -57,6 +59,21 @@ SmilMediaGroup::SmilMediaGroup()
 SmilMediaGroup::~SmilMediaGroup()
 {
 }
+
+//--------------------------------------------------
+/*!
+ the media nodes belong to the smil tree and are not deleted.  a group
+ that is reset is the same as a new one, but keeps its memory
+ */
+//--------------------------------------------------
+void SmilMediaGroup::reset()
+{
+    clear();
+    mbEscape = false;
+    mbPause = false;
+    mPauseId.clear();
+    mPauseLength.clear();
+}
 //--------------------------------------------------
 //set escape
 //--------------------------------------------------
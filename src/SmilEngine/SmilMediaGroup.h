@@ -51,6 +51,10 @@ public:
     //!destructor
     ~SmilMediaGroup();
 
+    //METHODS
+    //!empty the group so that it can be filled again
+    void reset();
+
     //ACCESS
     //!set escapability info
     void setEscape(bool);
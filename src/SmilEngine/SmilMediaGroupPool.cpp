@@ -0,0 +1,114 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+//PROJECT INCLUDES
+#include "SmilMediaGroupPool.h"
+
+using namespace std;
+using namespace amis;
+
+//--------------------------------------------------
+//Default constructor
+//--------------------------------------------------
+SmilMediaGroupPool::SmilMediaGroupPool()
+{
+    mNumCreated = 0;
+    pthread_mutex_init(&mPoolMutex, NULL);
+}
+
+//--------------------------------------------------
+//Destructor
+//--------------------------------------------------
+SmilMediaGroupPool::~SmilMediaGroupPool()
+{
+    for (unsigned int i = 0; i < mFreeGroups.size(); i++)
+    {
+        delete mFreeGroups[i];
+    }
+    mFreeGroups.clear();
+    pthread_mutex_destroy(&mPoolMutex);
+}
+
+//--------------------------------------------------
+//get an empty group, a new one if the pool is empty
+//--------------------------------------------------
+SmilMediaGroup* SmilMediaGroupPool::take()
+{
+    SmilMediaGroup* p_group = NULL;
+
+    pthread_mutex_lock(&mPoolMutex);
+    if (mFreeGroups.size() > 0)
+    {
+        p_group = mFreeGroups.back();
+        mFreeGroups.pop_back();
+    }
+    else
+    {
+        mNumCreated++;
+    }
+    pthread_mutex_unlock(&mPoolMutex);
+
+    if (p_group == NULL)
+        p_group = new SmilMediaGroup();
+
+    return p_group;
+}
+
+//--------------------------------------------------
+/*!
+ The group is reset before it goes back to the pool, its media nodes belong
+ to the smil tree and are not deleted.
+ */
+//--------------------------------------------------
+void SmilMediaGroupPool::give(SmilMediaGroup* pGroup)
+{
+    if (pGroup == NULL)
+        return;
+
+    pGroup->reset();
+
+    pthread_mutex_lock(&mPoolMutex);
+    mFreeGroups.push_back(pGroup);
+    pthread_mutex_unlock(&mPoolMutex);
+}
+
+//--------------------------------------------------
+//get the number of groups waiting in the pool
+//--------------------------------------------------
+unsigned int SmilMediaGroupPool::getNumberOfFreeGroups()
+{
+    pthread_mutex_lock(&mPoolMutex);
+    unsigned int size = mFreeGroups.size();
+    pthread_mutex_unlock(&mPoolMutex);
+
+    return size;
+}
+
+//--------------------------------------------------
+//get the number of groups created by the pool
+//--------------------------------------------------
+unsigned long SmilMediaGroupPool::getNumberOfCreatedGroups()
+{
+    pthread_mutex_lock(&mPoolMutex);
+    unsigned long created = mNumCreated;
+    pthread_mutex_unlock(&mPoolMutex);
+
+    return created;
+}
@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SMILMEDIAGROUPPOOL_H
+#define SMILMEDIAGROUPPOOL_H
+
+//SYSTEM INCLUDES
+#include <vector>
+#include <pthread.h>
+
+//PROJECT INCLUDES
+#include "SmilMediaGroup.h"
+
+namespace amis {
+
+//! The Smil Media Group Pool recycles media groups for navigation
+/*!
+ Each navigation command fills a media group, which is kept while its audio
+ plays and given back when the next one replaces it. Groups given back are
+ reset and handed out again by take(), so navigating does not allocate once
+ a few groups are in circulation.
+
+ The pool owns the groups it holds, a group that is taken belongs to the
+ caller until it is given back. All methods may be called from several
+ threads.
+ */
+class SMILENGINE_API SmilMediaGroupPool
+{
+
+public:
+    //LIFECYCLE
+    //!default constructor
+    SmilMediaGroupPool();
+    //!destructor, deletes the groups in the pool
+    ~SmilMediaGroupPool();
+
+    //METHODS
+    //!get an empty group, a new one if the pool is empty
+    SmilMediaGroup* take();
+    //!give a group back to the pool, NULL is ignored
+    void give(SmilMediaGroup*);
+
+    //ACCESS
+    //!get the number of groups waiting in the pool
+    unsigned int getNumberOfFreeGroups();
+    //!get the number of groups created by the pool
+    unsigned long getNumberOfCreatedGroups();
+
+private:
+    //MEMBER VARIABLES
+    //!the groups waiting to be taken
+    std::vector<SmilMediaGroup*> mFreeGroups;
+    //!number of groups created
+    unsigned long mNumCreated;
+    //!protects the pool
+    pthread_mutex_t mPoolMutex;
+};
+
+}  // namespace amis
+#endif
@@ -0,0 +1,487 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+//SYSTEM INCLUDES
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+
+//PROJECT INCLUDES
+#include "FilePathTools.h"
+#include "Media.h"
+#include "SmilEngineConstants.h"
+#include "Spine.h"
+#include "SmilTree.h"
+#include "SmilTreeBuilder.h"
+#include "Node.h"
+#include "TimeContainerNode.h"
+#include "ContentNode.h"
+#include "SmilTimeIndex.h"
+
+#include <log4cxx/logger.h>
+
+// create logger which will become a child to logger kolibre.amis
+log4cxx::LoggerPtr amisSmilTimeIndexLog(
+        log4cxx::Logger::getLogger("kolibre.amis.smiltimeindex"));
+
+using namespace std;
+
+//--------------------------------------------------
+//convert a clock value to milliseconds, -1 if it could not be parsed
+//--------------------------------------------------
+long SmilTimeIndex::clockValueToMs(string value)
+{
+    return amis::AudioNode::clockValueToMs(value);
+}
+
+//--------------------------------------------------
+//Default constructor
+//--------------------------------------------------
+SmilTimeIndex::SmilTimeIndex()
+{
+    pthread_mutex_init(&mDataMutex, NULL);
+    mbReady = false;
+    mbCancel = false;
+    mNumIndexed = 0;
+}
+
+//--------------------------------------------------
+//Destructor
+//--------------------------------------------------
+SmilTimeIndex::~SmilTimeIndex()
+{
+    clear();
+    pthread_mutex_destroy(&mDataMutex);
+}
+
+//--------------------------------------------------
+/*!
+ Parse every smil file in the spine and record its timing and head metadata.
+ The start of a file is taken from the totalelapsedtime metadata when it is
+ present and consistent, otherwise it is the end of the previous file.
+ @param[in] pProgress
+ called with the number of indexed files, the total and pProgressData after
+ each file, from the thread running the build
+ */
+//--------------------------------------------------
+amis::AmisError SmilTimeIndex::build(Spine* pSpine, int daisyVersion,
+        void (*pProgress)(unsigned int, unsigned int, void*),
+        void* pProgressData)
+{
+    amis::AmisError err;
+    err.setSourceModuleName(amis::module_SmilEngine);
+
+    pthread_mutex_lock(&mDataMutex);
+    mEntries.clear();
+    mFileIndex.clear();
+    mbReady = false;
+    mNumIndexed = 0;
+    pthread_mutex_unlock(&mDataMutex);
+
+    if (pSpine == NULL)
+    {
+        err.setCode(amis::NOT_INITIALIZED);
+        err.setMessage("No spine to index");
+        return err;
+    }
+
+    string elapsed_meta = "ncc:totalelapsedtime";
+    if (daisyVersion == DAISY3)
+        elapsed_meta = "dtb:totalelapsedtime";
+
+    unsigned long next_start = 0;
+    int num_files = pSpine->getNumberOfSmilFiles();
+
+    //entries are built aside and published when complete
+    vector<SmilEntry> entries;
+    entries.reserve(num_files);
+
+    for (int i = 0; i < num_files; i++)
+    {
+        if (isCancelled())
+        {
+            LOG4CXX_DEBUG(amisSmilTimeIndexLog, "Build cancelled");
+            err.setCode(amis::UNDEFINED_ERROR);
+            err.setMessage("Time index build cancelled");
+            return err;
+        }
+
+        SmilTreeBuilder builder;
+        SmilTree tree;
+        string smil_path = pSpine->getSmilFilePath(i);
+
+        builder.setDaisyVersion(daisyVersion);
+        err = builder.createSmilTree(&tree, smil_path);
+        if (err.getCode() != amis::OK)
+        {
+            LOG4CXX_ERROR(amisSmilTimeIndexLog,
+                    "Failed to index " << smil_path);
+            return err;
+        }
+
+        entries.push_back(SmilEntry());
+        SmilEntry& entry = entries.back();
+        entry.mSmilPath = smil_path;
+        entry.mStart = next_start;
+        entry.mDuration = 0;
+
+        for (unsigned int j = 0; j < builder.getNumberOfMetaItems(); j++)
+        {
+            entry.mMetadata.push_back(*builder.getMetaItem(j));
+        }
+
+        long elapsed = clockValueToMs(builder.getMetadata(elapsed_meta));
+        if (elapsed >= 0 && (i == 0 || (unsigned long) elapsed >= entries[i - 1].mStart))
+            entry.mStart = elapsed;
+
+        addClips(tree.getRoot(), entry, "");
+
+        if (entry.mClips.size() > 0)
+        {
+            ClipEntry& last = entry.mClips.back();
+            entry.mDuration = last.mOffset + (last.mClipEnd - last.mClipBegin);
+        }
+        else if (tree.getSmilDuration() > 0)
+        {
+            entry.mDuration = tree.getSmilDuration() * 1000;
+        }
+        else
+        {
+            long duration = clockValueToMs(
+                    builder.getMetadata("ncc:timeinthissmil"));
+            if (duration > 0)
+                entry.mDuration = duration;
+        }
+
+        next_start = entry.mStart + entry.mDuration;
+
+        pthread_mutex_lock(&mDataMutex);
+        mNumIndexed = i + 1;
+        pthread_mutex_unlock(&mDataMutex);
+
+        if (pProgress != NULL)
+            pProgress(i + 1, num_files, pProgressData);
+    }
+
+    pthread_mutex_lock(&mDataMutex);
+    mEntries.swap(entries);
+    for (unsigned int i = 0; i < mEntries.size(); i++)
+    {
+        mFileIndex[makeFileKey(mEntries[i].mSmilPath)] = i;
+    }
+    mbReady = true;
+    pthread_mutex_unlock(&mDataMutex);
+
+    LOG4CXX_DEBUG(amisSmilTimeIndexLog,
+            "Indexed " << mEntries.size() << " smil files, " << getTotalDuration() << " ms");
+
+    err.setCode(amis::OK);
+    return err;
+}
+
+//--------------------------------------------------
+//ask a running build to stop, the flag stays set until resetCancel() or
+//clear() so that a build which has not started yet is stopped too
+//--------------------------------------------------
+void SmilTimeIndex::cancel()
+{
+    pthread_mutex_lock(&mDataMutex);
+    mbCancel = true;
+    pthread_mutex_unlock(&mDataMutex);
+}
+
+//--------------------------------------------------
+//let the next build run after a cancel, keeps what has been indexed
+//--------------------------------------------------
+void SmilTimeIndex::resetCancel()
+{
+    pthread_mutex_lock(&mDataMutex);
+    mbCancel = false;
+    pthread_mutex_unlock(&mDataMutex);
+}
+
+//--------------------------------------------------
+//clear the index
+/*!
+ must not be called while a build is running on another thread
+ */
+//--------------------------------------------------
+void SmilTimeIndex::clear()
+{
+    pthread_mutex_lock(&mDataMutex);
+    mEntries.clear();
+    mFileIndex.clear();
+    mbReady = false;
+    mbCancel = false;
+    mNumIndexed = 0;
+    pthread_mutex_unlock(&mDataMutex);
+}
+
+//--------------------------------------------------
+/*!
+ Find the smil file and the audio clip that contain a time in the book.
+ @param[in] ms
+ time from the start of the book
+ @param[out] smilIdx
+ index of the smil file in the spine
+ @param[out] clipIdx
+ index of the clip in the smil file, -1 if the file has no audio
+ @param[out] clipOffset
+ time from the start of the clip
+ @return false if the time is beyond the end of the book
+ */
+//--------------------------------------------------
+bool SmilTimeIndex::lookup(unsigned long ms, int& smilIdx, int& clipIdx,
+        unsigned long& clipOffset)
+{
+    if (isReady() == false || mEntries.size() == 0)
+        return false;
+
+    //callers work in whole seconds, so accept the last partial second
+    if (ms > ((getTotalDuration() + 999) / 1000) * 1000)
+        return false;
+
+    //last smil file starting at or before ms
+    int low = 0;
+    int high = mEntries.size() - 1;
+    while (low < high)
+    {
+        int mid = (low + high + 1) / 2;
+        if (mEntries[mid].mStart <= ms)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+    smilIdx = low;
+
+    SmilEntry& entry = mEntries[smilIdx];
+    unsigned long offset = 0;
+    if (ms > entry.mStart)
+        offset = ms - entry.mStart;
+
+    clipIdx = -1;
+    clipOffset = 0;
+    if (entry.mClips.size() == 0)
+        return true;
+
+    //last clip starting at or before the offset
+    low = 0;
+    high = entry.mClips.size() - 1;
+    while (low < high)
+    {
+        int mid = (low + high + 1) / 2;
+        if (entry.mClips[mid].mOffset <= offset)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+    clipIdx = low;
+
+    ClipEntry& clip = entry.mClips[clipIdx];
+    if (offset > clip.mOffset)
+        clipOffset = offset - clip.mOffset;
+    if (clipOffset > clip.mClipEnd - clip.mClipBegin)
+        clipOffset = clip.mClipEnd - clip.mClipBegin;
+
+    return true;
+}
+
+//--------------------------------------------------
+//get the number of indexed smil files
+//--------------------------------------------------
+unsigned int SmilTimeIndex::getNumberOfSmilFiles()
+{
+    return mEntries.size();
+}
+
+//--------------------------------------------------
+//get the entry for a smil file, NULL if out of range
+//--------------------------------------------------
+const SmilTimeIndex::SmilEntry* SmilTimeIndex::getSmilEntry(unsigned int idx)
+{
+    if (idx >= mEntries.size())
+        return NULL;
+
+    return &mEntries[idx];
+}
+
+//--------------------------------------------------
+//get the index of a smil file, -1 if not indexed
+//--------------------------------------------------
+int SmilTimeIndex::findSmilFile(string smilPath)
+{
+    if (isReady() == false)
+        return -1;
+
+    map<string, int>::const_iterator iter = mFileIndex.find(
+            makeFileKey(smilPath));
+    if (iter == mFileIndex.end())
+        return -1;
+
+    return iter->second;
+}
+
+//--------------------------------------------------
+//get metadata from the head of an indexed smil file
+//--------------------------------------------------
+string SmilTimeIndex::getMetadata(unsigned int idx, string metaname)
+{
+    if (isReady() == false || idx >= mEntries.size())
+        return "";
+
+    vector<amis::MetaItem>& metadata = mEntries[idx].mMetadata;
+    for (unsigned int i = 0; i < metadata.size(); i++)
+    {
+        if (metadata[i].mName.compare(metaname) == 0)
+            return metadata[i].mContent;
+    }
+
+    return "";
+}
+
+//--------------------------------------------------
+//get the number of smil files indexed so far
+//--------------------------------------------------
+unsigned int SmilTimeIndex::getNumberOfIndexedFiles()
+{
+    pthread_mutex_lock(&mDataMutex);
+    unsigned int num_indexed = mNumIndexed;
+    pthread_mutex_unlock(&mDataMutex);
+
+    return num_indexed;
+}
+
+//--------------------------------------------------
+//get the total duration of the book
+//--------------------------------------------------
+unsigned long SmilTimeIndex::getTotalDuration()
+{
+    if (mEntries.size() == 0)
+        return 0;
+
+    return mEntries.back().mStart + mEntries.back().mDuration;
+}
+
+//--------------------------------------------------
+//has the index been built?
+//--------------------------------------------------
+bool SmilTimeIndex::isReady()
+{
+    pthread_mutex_lock(&mDataMutex);
+    bool b_ready = mbReady;
+    pthread_mutex_unlock(&mDataMutex);
+
+    return b_ready;
+}
+
+//--------------------------------------------------
+//is a build cancelled?
+//--------------------------------------------------
+bool SmilTimeIndex::isCancelled()
+{
+    pthread_mutex_lock(&mDataMutex);
+    bool b_cancel = mbCancel;
+    pthread_mutex_unlock(&mDataMutex);
+
+    return b_cancel;
+}
+
+//--------------------------------------------------
+//smil files are looked up by their lower case file name, since positions
+//may refer to a file with a different base path than the spine
+//--------------------------------------------------
+string SmilTimeIndex::makeFileKey(string smilPath)
+{
+    string key = amis::FilePathTools::getFileName(
+            amis::FilePathTools::clearTarget(smilPath));
+    std::transform(key.begin(), key.end(), key.begin(),
+            (int (*)(int))tolower);
+
+    return key;
+}
+
+//--------------------------------------------------
+/*!
+ Walk the children of a node in document order and record audio clips and
+ text ids. Clips are laid out back to back, so the offset of a clip is the sum
+ of the lengths of the clips before it.
+ */
+//--------------------------------------------------
+void SmilTimeIndex::addClips(Node* pNode, SmilEntry& entry, string containerId)
+{
+    if (pNode == NULL)
+        return;
+
+    if (pNode->getCategoryOfNode() == TIME_CONTAINER)
+    {
+        TimeContainerNode* p_container = (TimeContainerNode*) pNode;
+
+        if (p_container->getElementId().size() > 0)
+            containerId = p_container->getElementId();
+
+        Node* p_child = p_container->getChild(0);
+        while (p_child != NULL)
+        {
+            addClips(p_child, entry, containerId);
+            p_child = p_child->getFirstSibling();
+        }
+        return;
+    }
+
+    amis::MediaNode* p_media = ((ContentNode*) pNode)->getMediaNode();
+    if (p_media == NULL)
+        return;
+
+    if (pNode->getTypeOfNode() == TXT)
+    {
+        entry.mTextIds.push_back(p_media->getId());
+    }
+    else if (pNode->getTypeOfNode() == AUD)
+    {
+        amis::AudioNode* p_audio = (amis::AudioNode*) p_media;
+        long clip_begin = p_audio->getClipBeginMs();
+        long clip_end = p_audio->getClipEndMs();
+
+        if (clip_begin < 0 || clip_end < clip_begin)
+        {
+            LOG4CXX_WARN(amisSmilTimeIndexLog,
+                    "Ignoring clip " << p_audio->getId() << " in " << entry.mSmilPath);
+            return;
+        }
+
+        ClipEntry clip;
+        clip.mContainerId = containerId;
+        clip.mAudioId = p_audio->getId();
+        clip.mClipBegin = clip_begin;
+        clip.mClipEnd = clip_end;
+        clip.mOffset = 0;
+        clip.mNumTextIds = entry.mTextIds.size();
+
+        if (entry.mClips.size() > 0)
+        {
+            ClipEntry& prev = entry.mClips.back();
+            clip.mOffset = prev.mOffset + (prev.mClipEnd - prev.mClipBegin);
+        }
+
+        entry.mClips.push_back(clip);
+    }
+}
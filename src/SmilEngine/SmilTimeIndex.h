@@ -0,0 +1,151 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SMILTIMEINDEX_H
+#define SMILTIMEINDEX_H
+
+//SYSTEM INCLUDES
+#include <string>
+#include <vector>
+#include <map>
+#include <pthread.h>
+
+//PROJECT INCLUDES
+#include "AmisError.h"
+#include "MetadataSet.h"
+
+class Node;
+class Spine;
+
+//! The Smil Time Index maps book time to smil files and audio clips
+/*!
+ The index is built once per book by walking every smil file in the spine.
+ For each file it stores the start offset, the duration and the audio clips
+ with their offset from the start of the file, so that a time in the book can
+ be resolved to a file and a clip with two binary searches and no xml parsing.
+ All times are in milliseconds.
+
+ The index may be built on a background thread. Entries are published all at
+ once when the build completes, so readers must check isReady() first.
+ */
+class SmilTimeIndex
+{
+
+public:
+    //!an audio clip in a smil file
+    struct ClipEntry
+    {
+        //!id of the innermost time container with an id
+        std::string mContainerId;
+        //!id of the audio element
+        std::string mAudioId;
+        //!clip begin in the audio file
+        unsigned long mClipBegin;
+        //!clip end in the audio file
+        unsigned long mClipEnd;
+        //!offset from the start of the smil file
+        unsigned long mOffset;
+        //!number of text ids that precede this clip in the smil file
+        unsigned int mNumTextIds;
+    };
+
+    //!a smil file in the spine
+    struct SmilEntry
+    {
+        //!path to the smil file
+        std::string mSmilPath;
+        //!offset from the start of the book
+        unsigned long mStart;
+        //!duration of the smil file
+        unsigned long mDuration;
+        //!audio clips in document order
+        std::vector<ClipEntry> mClips;
+        //!text ids in document order
+        std::vector<std::string> mTextIds;
+        //!metadata from the smil head
+        std::vector<amis::MetaItem> mMetadata;
+    };
+
+    //LIFECYCLE
+    //!default constructor
+    SmilTimeIndex();
+    //!destructor
+    ~SmilTimeIndex();
+
+    //METHODS
+    //!build the index from all smil files in a spine
+    amis::AmisError build(Spine*, int,
+            void (*pProgress)(unsigned int, unsigned int, void*) = NULL,
+            void* pProgressData = NULL);
+    //!ask a running build to stop
+    void cancel();
+    //!let the next build run after a cancel
+    void resetCancel();
+    //!clear the index
+    void clear();
+    //!find the smil file and clip at a time in the book
+    bool lookup(unsigned long, int&, int&, unsigned long&);
+
+    //ACCESS
+    //!get the number of indexed smil files
+    unsigned int getNumberOfSmilFiles();
+    //!get the entry for a smil file
+    const SmilEntry* getSmilEntry(unsigned int);
+    //!get the index of a smil file, -1 if not indexed
+    int findSmilFile(std::string);
+    //!get metadata from the head of an indexed smil file
+    std::string getMetadata(unsigned int, std::string);
+    //!get the number of smil files indexed so far
+    unsigned int getNumberOfIndexedFiles();
+    //!get the total duration of the book
+    unsigned long getTotalDuration();
+
+    //!convert a smil clock value to milliseconds, -1 if it is invalid
+    static long clockValueToMs(std::string);
+
+    //INQUIRY
+    //!has the index been built?
+    bool isReady();
+
+private:
+    //METHODS
+    //!collect the audio clips and text ids below a node
+    void addClips(Node*, SmilEntry&, std::string);
+    //!is a build cancelled?
+    bool isCancelled();
+    //!make the key used to look up a smil file
+    std::string makeFileKey(std::string);
+
+    //MEMBER VARIABLES
+    //!entries in spine order
+    std::vector<SmilEntry> mEntries;
+    //!file name to entry index
+    std::map<std::string, int> mFileIndex;
+    //!ready flag
+    bool mbReady;
+    //!cancel flag
+    bool mbCancel;
+    //!number of files indexed by a running build
+    unsigned int mNumIndexed;
+    //!protects the flags and the published entries
+    pthread_mutex_t mDataMutex;
+};
+
+#endif
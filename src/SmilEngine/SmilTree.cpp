@@ -39,6 +39,7 @@
 
 #include "SmilTree.h"
 #include <math.h>
+#include <algorithm>
 
 #include <log4cxx/logger.h>
 
@@ -61,6 +62,7 @@ SmilTree::SmilTree()
     mbEscapeRequested = false;
     mbCouldEscape = false;
     mDuration = 0;
+    mbTimeTableBuilt = false;
 }
 
 //--------------------------------------------------
@@ -68,8 +70,8 @@ SmilTree::SmilTree()
 //--------------------------------------------------
 SmilTree::~SmilTree()
 {
-    //delete the root node
-    delete mpRoot;
+    //destroy the nodes in creation order and free the blocks
+    mArena.clear();
 }
 
 //--------------------------------------------------
@@ -78,6 +80,7 @@ SmilTree::~SmilTree()
 void SmilTree::setRoot(SeqNode* pNewRoot)
 {
     mpRoot = pNewRoot;
+    mbTimeTableBuilt = false;
 }
 
 //--------------------------------------------------
@@ -88,6 +91,14 @@ Node* SmilTree::getRoot()
     return mpRoot;
 }
 
+//--------------------------------------------------
+//get the arena that owns the nodes of this tree
+//--------------------------------------------------
+NodeArena* SmilTree::getArena()
+{
+    return &mArena;
+}
+
 //--------------------------------------------------
 //go to the first set of parallel nodes in the tree
 //--------------------------------------------------
@@ -125,11 +136,8 @@ amis::AmisError SmilTree::goFirst(amis::SmilMediaGroup* pMedia)
         //record the tree status as OK
         mTreeStatus = amis::OK;
 
-        this->mCurrentId = "";
         //gather the playback data and send it to the Smil Engine
-        mpRoot->play(pMedia);
-        pMedia->setId(this->mCurrentId);
-        pMedia->setEscape(mbCouldEscape);
+        playCurrent(pMedia);
         err.setCode(amis::OK);
 
     }
@@ -182,11 +190,8 @@ amis::AmisError SmilTree::goLast(amis::SmilMediaGroup* pMedia)
         //record the tree status as being OK
         mTreeStatus = amis::OK;
 
-        this->mCurrentId = "";
         //gather the playback data and send it to the Smil Engine
-        mpRoot->play(pMedia);
-        pMedia->setEscape(mbCouldEscape);
-        pMedia->setId(this->mCurrentId);
+        playCurrent(pMedia);
         err.setCode(amis::OK);
     }
     else
@@ -250,11 +255,8 @@ amis::AmisError SmilTree::goNext(amis::SmilMediaGroup* pMedia)
             //record the tree status as amis::OK
             mTreeStatus = amis::OK;
 
-            this->mCurrentId = "";
             //gather the playback data and send it to the Smil Engine
-            mpRoot->play(pMedia);
-            pMedia->setEscape(mbCouldEscape);
-            pMedia->setId(this->mCurrentId);
+            playCurrent(pMedia);
             err.setCode(amis::OK);
         }
 
@@ -321,11 +323,8 @@ amis::AmisError SmilTree::goPrevious(amis::SmilMediaGroup* pMedia)
             //record the tree status as amis::OK
             mTreeStatus = amis::OK;
 
-            this->mCurrentId = "";
             //gather the playback data and send it to the Smil Engine
-            mpRoot->play(pMedia);
-            pMedia->setId(this->mCurrentId);
-            pMedia->setEscape(mbCouldEscape);
+            playCurrent(pMedia);
             err.setCode(amis::OK);
         }
 
@@ -452,6 +451,55 @@ void SmilTree::addContentRegion(ContentRegionData region)
     mRegions.push_back(region);
 }
 
+//--------------------------------------------------
+/*!
+ Called by the tree builder for each node added below the root. The nodes
+ arrive in document order, so keeping the first node with an id finds the
+ same node as the depth first search in TimeContainerNode::setAtId.
+ */
+//--------------------------------------------------
+void SmilTree::addNodeId(Node* pNode)
+{
+    if (pNode->getElementId().size() > 0)
+        mIdIndex.insert(make_pair(pNode->getElementId(), pNode));
+}
+
+//--------------------------------------------------
+//find the node with an id
+//--------------------------------------------------
+Node* SmilTree::getNodeById(string id)
+{
+    tr1::unordered_map<string, Node*>::const_iterator iter = mIdIndex.find(id);
+    if (iter == mIdIndex.end())
+        return NULL;
+
+    return iter->second;
+}
+
+//--------------------------------------------------
+/*!
+ Point each seq above the node at the child leading to it, the same cursors
+ TimeContainerNode::setAtId sets on its way back up. A seq found by id
+ starts from its first child.
+ */
+//--------------------------------------------------
+void SmilTree::setAtNode(Node* pNode)
+{
+    if (pNode->getTypeOfNode() == SEQ)
+        ((SeqNode*) pNode)->setChildIndex(0);
+
+    Node* p_child = pNode;
+    TimeContainerNode* p_parent = pNode->getParent();
+    while (p_parent != NULL)
+    {
+        if (p_parent->getTypeOfNode() == SEQ)
+            ((SeqNode*) p_parent)->setChildIndex(p_child->getIndexInParent());
+
+        p_child = p_parent;
+        p_parent = p_parent->getParent();
+    }
+}
+
 //--------------------------------------------------
 //return a pointer to the content regions list
 //--------------------------------------------------
@@ -581,12 +629,26 @@ amis::AmisError SmilTree::goToId(string id, amis::SmilMediaGroup* pMedia)
     }
     else
     {
-        if (mpRoot->setAtId(id) == true)
+        //look the id up in the index built with the tree, trees without
+        //an index and nodes without an id are searched for
+        bool b_found = false;
+        if (mIdIndex.size() > 0 && id.size() > 0)
         {
-            this->mCurrentId = "";
-            mpRoot->play(pMedia);
-            pMedia->setId(this->mCurrentId);
-            pMedia->setEscape(mbCouldEscape);
+            Node* p_node = getNodeById(id);
+            if (p_node != NULL)
+            {
+                setAtNode(p_node);
+                b_found = true;
+            }
+        }
+        else
+        {
+            b_found = mpRoot->setAtId(id);
+        }
+
+        if (b_found == true)
+        {
+            playCurrent(pMedia);
         }
         else
         {
@@ -603,6 +665,397 @@ amis::AmisError SmilTree::goToId(string id, amis::SmilMediaGroup* pMedia)
     return err;
 }
 
+//--------------------------------------------------
+/*!
+ Go to the audio clip playing at a time, without stepping through the clips
+ before it.
+ @param[in] ms
+ time from the start of the smil file
+ @param[out] pMedia
+ the media group of the clip
+ @param[out] clipOffset
+ time from the start of the clip
+ */
+//--------------------------------------------------
+amis::AmisError SmilTree::goToTime(unsigned long ms,
+        amis::SmilMediaGroup* pMedia, unsigned long& clipOffset)
+{
+    LOG4CXX_TRACE(amisSmilTreeLog, "goToTime" );
+
+    amis::AmisError err;
+    err.setSourceModuleName(amis::module_SmilEngine);
+
+    if(!mpRoot){
+        LOG4CXX_ERROR(amisSmilTreeLog, "Skipping command because mpRoot is null" );
+        err.setCode(amis::NOT_INITIALIZED);
+        return err;
+    }
+
+    int idx = findClipAtTime(ms);
+    if (idx < 0)
+    {
+        err.setCode(amis::NOT_FOUND);
+        err.setMessage("No audio was found in " + getSmilFilePath());
+        return err;
+    }
+
+    //a time past the end of the file is the end of the last clip
+    clipOffset = min(ms, mClipStarts[idx + 1]) - mClipStarts[idx];
+
+    playAtNode(mClipNodes[idx], pMedia);
+
+    err.setCode(amis::OK);
+    return err;
+}
+
+//--------------------------------------------------
+/*!
+ Go to the group holding an audio clip, the way a bookmark or lastmark with
+ an audio ref is resumed. The clip is found through the id index, so the
+ groups before it are not played. If the clip is inside a structure the
+ skip options turn off, the next group that is played is returned instead,
+ or AT_END when there is none left in this file.
+ */
+//--------------------------------------------------
+amis::AmisError SmilTree::goToAudioId(string id, amis::SmilMediaGroup* pMedia)
+{
+    LOG4CXX_TRACE(amisSmilTreeLog, "goToAudioId" );
+
+    amis::AmisError err;
+    err.setSourceModuleName(amis::module_SmilEngine);
+
+    if(!mpRoot){
+        LOG4CXX_ERROR(amisSmilTreeLog, "Skipping command because mpRoot is null" );
+        err.setCode(amis::NOT_INITIALIZED);
+        return err;
+    }
+
+    Node* p_node = getNodeById(id);
+    if (p_node == NULL || p_node->getTypeOfNode() != AUD)
+    {
+        err.setCode(amis::NOT_FOUND);
+        err.setMessage(
+                "The audio clip *" + id + "* was not found in "
+                        + getSmilFilePath());
+        return err;
+    }
+
+    //the lookup does not go through setNext, so check the skip options on
+    //the seqs and pars holding the clip here
+    TimeContainerNode* p_parent = p_node->getParent();
+    while (p_parent != NULL && mustSkipOrEscapeNode(p_parent) == false)
+        p_parent = p_parent->getParent();
+
+    if (p_parent != NULL)
+    {
+        setAtNode(p_node);
+        mTreeStatus = amis::OK;
+        return goNext(pMedia);
+    }
+
+    playAtNode(p_node, pMedia);
+
+    err.setCode(amis::OK);
+    return err;
+}
+
+//--------------------------------------------------
+//set the tree at a node and play the group holding it
+//--------------------------------------------------
+void SmilTree::playAtNode(Node* pNode, amis::SmilMediaGroup* pMedia)
+{
+    setAtNode(pNode);
+    playCurrent(pMedia);
+}
+
+//--------------------------------------------------
+/*!
+ Empty the media group and fill it with the group the tree is at. The media
+ nodes are not copied, the group points at the nodes of the tree, so a group
+ can be filled again and again without allocating.
+ */
+//--------------------------------------------------
+void SmilTree::playCurrent(amis::SmilMediaGroup* pMedia)
+{
+    pMedia->reset();
+    this->mCurrentId = "";
+    mpRoot->play(pMedia);
+    pMedia->setId(this->mCurrentId);
+    pMedia->setEscape(mbCouldEscape);
+}
+
+//--------------------------------------------------
+//get the start times of the audio clips in milliseconds
+/*!
+ The times are sums of the clip durations in document order, the item after
+ the last clip is the total duration of the audio in the file.
+ */
+//--------------------------------------------------
+const vector<unsigned long>& SmilTree::getClipStartTimes()
+{
+    buildTimeTable();
+    return mClipStarts;
+}
+
+//--------------------------------------------------
+//get the ids of the text elements before the clip playing at a time
+//--------------------------------------------------
+void SmilTree::getTextIdsBefore(unsigned long ms, vector<string>& textIds)
+{
+    textIds.clear();
+
+    int idx = findClipAtTime(ms);
+    if (idx < 0)
+        return;
+
+    textIds.assign(mTextIds.begin(), mTextIds.begin() + mClipTextCounts[idx]);
+}
+
+//--------------------------------------------------
+/*!
+ Add the audio clips that goNext would reach from the current group, in the
+ order it would reach them, until the list holds count clips. The tree is
+ not moved.
+ */
+//--------------------------------------------------
+void SmilTree::getClipsAfterCurrent(unsigned int count,
+        vector<PlaylistClip>& clips)
+{
+    if (mpRoot == NULL)
+        return;
+
+    //goNext plays the first group when the tree is at the beginning
+    if (mTreeStatus == amis::AT_BEGINNING)
+    {
+        getClipsFromStart(count, clips);
+        return;
+    }
+
+    Node* p_child = getCurrentNode();
+    TimeContainerNode* p_parent = p_child->getParent();
+    while (p_parent != NULL)
+    {
+        //the other children of a par belong to the current group
+        if (p_parent->getTypeOfNode() == SEQ)
+        {
+            for (int i = p_child->getIndexInParent() + 1;
+                    i < p_parent->NumChildren(); i++)
+            {
+                if (addClips(p_parent->getChild(i), count, clips) == false)
+                    return;
+            }
+        }
+
+        p_child = p_parent;
+        p_parent = p_parent->getParent();
+    }
+}
+
+//--------------------------------------------------
+//add the audio clips from the start of the tree until a list is full
+//--------------------------------------------------
+void SmilTree::getClipsFromStart(unsigned int count,
+        vector<PlaylistClip>& clips)
+{
+    addClips(mpRoot, count, clips);
+}
+
+//--------------------------------------------------
+/*!
+ Follow the active children from the root, the way play does. A par steps
+ through its first seq that is not skipped, a par without one is the
+ innermost node itself.
+ */
+//--------------------------------------------------
+Node* SmilTree::getCurrentNode()
+{
+    Node* p_node = mpRoot;
+
+    while (p_node->getCategoryOfNode() == TIME_CONTAINER)
+    {
+        TimeContainerNode* p_container = (TimeContainerNode*) p_node;
+        Node* p_next = NULL;
+
+        if (p_node->getTypeOfNode() == SEQ)
+        {
+            int idx = ((SeqNode*) p_node)->getChildIndex();
+            if (idx >= 0 && idx < p_container->NumChildren())
+                p_next = p_container->getChild(idx);
+        }
+        else
+        {
+            for (int i = 0; i < p_container->NumChildren(); i++)
+            {
+                if (p_container->getChild(i)->getTypeOfNode() == SEQ
+                        && mustSkipOrEscapeNode(p_container->getChild(i))
+                                == false)
+                {
+                    p_next = p_container->getChild(i);
+                    break;
+                }
+            }
+        }
+
+        if (p_next == NULL)
+            break;
+
+        p_node = p_next;
+    }
+
+    return p_node;
+}
+
+//--------------------------------------------------
+/*!
+ Add the audio clips below a node in document order, leaving out the time
+ containers that are skipped. The group id is the id of the nearest time
+ container that has one, as play would set it, and the text id is taken
+ from the text of the nearest par that has one.
+ @return false when the list holds count clips
+ */
+//--------------------------------------------------
+bool SmilTree::addClips(Node* pNode, unsigned int count,
+        vector<PlaylistClip>& clips)
+{
+    if (clips.size() >= count)
+        return false;
+
+    if (pNode == NULL)
+        return true;
+
+    if (pNode->getCategoryOfNode() == TIME_CONTAINER)
+    {
+        if (mustSkipOrEscapeNode(pNode) == true)
+            return true;
+
+        TimeContainerNode* p_container = (TimeContainerNode*) pNode;
+        for (int i = 0; i < p_container->NumChildren(); i++)
+        {
+            if (addClips(p_container->getChild(i), count, clips) == false)
+                return false;
+        }
+        return true;
+    }
+
+    amis::MediaNode* p_media = ((ContentNode*) pNode)->getMediaNode();
+    if (pNode->getTypeOfNode() != AUD || p_media == NULL)
+        return true;
+
+    amis::AudioNode* p_audio = (amis::AudioNode*) p_media;
+    PlaylistClip clip;
+    clip.mSmilFile = mSmilFilePath;
+    clip.mAudioId = p_audio->getId();
+    clip.mSrc = p_audio->getSrc();
+    clip.mClipBeginMs = p_audio->getClipBeginMs();
+    clip.mClipEndMs = p_audio->getClipEndMs();
+
+    TimeContainerNode* p_parent = pNode->getParent();
+    while (p_parent != NULL)
+    {
+        if (clip.mGroupId.empty())
+            clip.mGroupId = p_parent->getElementId();
+
+        if (clip.mTextId.empty() && p_parent->getTypeOfNode() == PAR)
+        {
+            for (int i = 0; i < p_parent->NumChildren(); i++)
+            {
+                Node* p_child = p_parent->getChild(i);
+                if (p_child->getTypeOfNode() == TXT
+                        && ((ContentNode*) p_child)->getMediaNode() != NULL)
+                {
+                    clip.mTextId =
+                            ((ContentNode*) p_child)->getMediaNode()->getId();
+                    break;
+                }
+            }
+        }
+
+        p_parent = p_parent->getParent();
+    }
+
+    clips.push_back(clip);
+
+    return clips.size() < count;
+}
+
+//--------------------------------------------------
+//build the time table the first time it is needed
+//--------------------------------------------------
+void SmilTree::buildTimeTable()
+{
+    if (mbTimeTableBuilt == true)
+        return;
+
+    mClipStarts.clear();
+    mClipNodes.clear();
+    mClipTextCounts.clear();
+    mTextIds.clear();
+
+    mClipStarts.push_back(0);
+    addToTimeTable(mpRoot);
+
+    mbTimeTableBuilt = true;
+}
+
+//--------------------------------------------------
+//add the audio clips and text ids below a node in document order
+//--------------------------------------------------
+void SmilTree::addToTimeTable(Node* pNode)
+{
+    if (pNode == NULL)
+        return;
+
+    if (pNode->getCategoryOfNode() == TIME_CONTAINER)
+    {
+        TimeContainerNode* p_container = (TimeContainerNode*) pNode;
+        for (int i = 0; i < p_container->NumChildren(); i++)
+        {
+            addToTimeTable(p_container->getChild(i));
+        }
+        return;
+    }
+
+    amis::MediaNode* p_media = ((ContentNode*) pNode)->getMediaNode();
+    if (p_media == NULL)
+        return;
+
+    if (pNode->getTypeOfNode() == TXT)
+    {
+        mTextIds.push_back(p_media->getId());
+    }
+    else if (pNode->getTypeOfNode() == AUD)
+    {
+        amis::AudioNode* p_audio = (amis::AudioNode*) p_media;
+        long clip_begin = p_audio->getClipBeginMs();
+        long clip_end = p_audio->getClipEndMs();
+
+        //skip the clips the time index skips, so that the offsets agree
+        if (clip_begin < 0 || clip_end < clip_begin)
+            return;
+
+        mClipNodes.push_back(pNode);
+        mClipTextCounts.push_back(mTextIds.size());
+        mClipStarts.push_back(mClipStarts.back() + (clip_end - clip_begin));
+    }
+}
+
+//--------------------------------------------------
+//get the index of the last clip starting at or before a time
+//--------------------------------------------------
+int SmilTree::findClipAtTime(unsigned long ms)
+{
+    buildTimeTable();
+
+    if (mClipNodes.size() == 0)
+        return -1;
+
+    //leave out the total, it is not the start of a clip
+    vector<unsigned long>::const_iterator it = upper_bound(
+            mClipStarts.begin(), mClipStarts.end() - 1, ms);
+
+    return (it - mClipStarts.begin()) - 1;
+}
+
 //--------------------------------------------------
 //Set the smil file path that is the source for this tree
 //--------------------------------------------------
@@ -693,6 +1146,31 @@ void SmilTree::setSmilDuration(unsigned int duration)
     mDuration = duration;
 }
 
+//--------------------------------------------------
+//add metadata from the smil head
+//--------------------------------------------------
+void SmilTree::addMetadata(string name, string content)
+{
+    amis::MetaItem item;
+    item.mName = name;
+    item.mContent = content;
+    mMetadata.push_back(item);
+}
+
+//--------------------------------------------------
+//get metadata from the smil head, empty if not found
+//--------------------------------------------------
+string SmilTree::getMetadata(string name)
+{
+    for (unsigned int i = 0; i < mMetadata.size(); i++)
+    {
+        if (mMetadata[i].mName.compare(name) == 0)
+            return mMetadata[i].mContent;
+    }
+
+    return "";
+}
+
 // "0:0:0.5456" -> unsigned int
 // "32.435" -> unsigned int
 // "0:45:23" -> unsigned int
@@ -25,14 +25,18 @@
 
 //SYSTEM INCLUDES
 #include <string>
+#include <vector>
+#include <tr1/unordered_map>
 
 //PROJECT INCLUDES
 #include "AmisError.h"
 #include "CustomTest.h"
+#include "MetadataSet.h"
 
 #include "SmilMediaGroup.h"
 #include "SmilEngineConstants.h"
 #include "Node.h"
+#include "NodeArena.h"
 #include "SeqNode.h"
 
 //! The Smil Tree is a tree structure representing the contents of one SMIL file.
@@ -60,6 +64,8 @@ public:
     void setRoot(SeqNode*);
     //!get the root node
     Node* getRoot();
+    //!get the arena that owns the nodes
+    NodeArena* getArena();
 
     //!set the smil file path
     void setSmilFilePath(std::string);
@@ -99,6 +105,16 @@ public:
     //!get a list of content region data
     std::vector<ContentRegionData> getContentRegionList();
 
+    //!add metadata from the smil head
+    void addMetadata(std::string, std::string);
+    //!get metadata from the smil head
+    std::string getMetadata(std::string);
+
+    //!add a node to the id index, the first node with an id is kept
+    void addNodeId(Node*);
+    //!find the node with an id, NULL if not in the index
+    Node* getNodeById(std::string);
+
     //METHODS
     //!print the tree
     void print();
@@ -115,6 +131,21 @@ public:
     amis::AmisError goToId(std::string, amis::SmilMediaGroup*);
     //!escape current structure
     amis::AmisError escapeStructure(amis::SmilMediaGroup*);
+    //!go to the group holding the audio clip with an id
+    amis::AmisError goToAudioId(std::string, amis::SmilMediaGroup*);
+    //!go to the audio clip playing at a time from the start of the file
+    amis::AmisError goToTime(unsigned long, amis::SmilMediaGroup*,
+            unsigned long&);
+
+    //!get the start times of the audio clips, followed by the total
+    const std::vector<unsigned long>& getClipStartTimes();
+    //!get the ids of the text elements before the clip playing at a time
+    void getTextIdsBefore(unsigned long, std::vector<std::string>&);
+
+    //!add the audio clips after the current group until a list is full
+    void getClipsAfterCurrent(unsigned int, std::vector<PlaylistClip>&);
+    //!add the audio clips from the start of the tree until a list is full
+    void getClipsFromStart(unsigned int, std::vector<PlaylistClip>&);
 
     //INQUIRY
     //!is the tree empty?
@@ -130,7 +161,28 @@ private:
     //!convert a duration string to seconds
     unsigned int stringToSeconds(std::string timeString);
 
+    //!set the seqs above a node to play starting at that node
+    void setAtNode(Node*);
+    //!play the group holding a node
+    void playAtNode(Node*, amis::SmilMediaGroup*);
+    //!fill a media group with the group the tree is at
+    void playCurrent(amis::SmilMediaGroup*);
+
+    //!build the table of audio clip start times
+    void buildTimeTable();
+    //!add the clips and text ids below a node to the time table
+    void addToTimeTable(Node*);
+    //!get the index of the clip playing at a time, -1 if there is none
+    int findClipAtTime(unsigned long);
+
+    //!find the innermost node of the group the tree is at
+    Node* getCurrentNode();
+    //!add the clips below a node that would be played, false when the list is full
+    bool addClips(Node*, unsigned int, std::vector<PlaylistClip>&);
+
     //MEMBER VARIABLES
+    //!the nodes and their media objects
+    NodeArena mArena;
     //!root of the tree
     SeqNode* mpRoot;
     //!current escape node if exists
@@ -139,6 +191,23 @@ private:
     //!content region list
     std::vector<ContentRegionData> mRegions;
 
+    //!metadata from the smil head
+    std::vector<amis::MetaItem> mMetadata;
+
+    //!nodes below the root by element id
+    std::tr1::unordered_map<std::string, Node*> mIdIndex;
+
+    //!start of each audio clip in milliseconds, the last item is the total
+    std::vector<unsigned long> mClipStarts;
+    //!audio clip nodes in document order
+    std::vector<Node*> mClipNodes;
+    //!number of text ids before each audio clip
+    std::vector<unsigned int> mClipTextCounts;
+    //!text ids in document order
+    std::vector<std::string> mTextIds;
+    //!has the time table been built?
+    bool mbTimeTableBuilt;
+
     //!skippable options list
     std::vector<amis::CustomTest*>* mpSkipOptions;
 
@@ -25,6 +25,7 @@
 #include <iostream>
 #include <cstring>
 #include <algorithm>
+#include <sys/stat.h>
 
 
 //PROJECT INCLUDES
@@ -64,6 +65,9 @@ SmilTreeBuilder::SmilTreeBuilder():
     mDaisyVersion = 0;
     mbLinkOpen = false;
     mLinkHref = "";
+    mpSmilTree = NULL;
+    mbHeadOnly = false;
+    mbHeadDone = false;
     mError.setSourceModuleName(amis::module_SmilEngine);
 }
 
@@ -106,13 +110,73 @@ int SmilTreeBuilder::getDaisyVersion()
 //--------------------------------------------------
 amis::AmisError SmilTreeBuilder::createSmilTree(SmilTree *pSmilTree,
         string filePath)
+{
+    //save a pointer to the smil tree that we will populate
+    mpSmilTree = pSmilTree;
+
+    //the nodes belong to the tree, size its arena blocks to the file
+    mNodeBuilder.setArena(mpSmilTree->getArena());
+    struct stat file_stat;
+    string local_path = amis::FilePathTools::getAsLocalFilePath(filePath);
+    if (stat(local_path.c_str(), &file_stat) == 0)
+    {
+        mpSmilTree->getArena()->setExpectedSize(
+                file_stat.st_size * ARENA_BYTES_PER_SMIL_BYTE);
+    }
+
+    //save the full path to this smil file
+    mpSmilTree->setSmilFilePath(filePath);
+
+    //set the default value for couldescape
+    mpSmilTree->setCouldEscape(false);
+
+    mbHeadOnly = false;
+
+    amis::AmisError err = parseFile(filePath);
+
+    //keep the metadata with the tree so it outlives this builder
+    for (unsigned int i = 0; i < mMetaList.size(); i++)
+    {
+        pSmilTree->addMetadata(mMetaList[i]->mName, mMetaList[i]->mContent);
+    }
+
+    return err;
+
+} //end SmilTreeBuilder::createSmilTree function
+
+//--------------------------------------------------
+/*!
+ Read only the metadata from the head of a SMIL file.
+ The parse stops at the end of the head, no tree is built and the
+ result is available through getMetadata() and getMetaItem().
+ */
+//--------------------------------------------------
+amis::AmisError SmilTreeBuilder::readSmilHead(string filePath)
+{
+    amis::AmisError err;
+
+    mpSmilTree = NULL;
+    mbHeadOnly = true;
+
+    err = parseFile(filePath);
+
+    mbHeadOnly = false;
+
+    return err;
+}
+
+//--------------------------------------------------
+//reset the builder state and run the parser on a file
+//--------------------------------------------------
+amis::AmisError SmilTreeBuilder::parseFile(string filePath)
 {
     //local variables
-    int i;
     string tmp_string;
 
     //reset all variables
     mLinkHref = "";
+    mbLinkOpen = false;
+    mbHeadDone = false;
     mSmilSourceFile = "";
 
     mError.setCode(amis::OK);
@@ -124,27 +188,11 @@ amis::AmisError SmilTreeBuilder::createSmilTree(SmilTree *pSmilTree,
 
     mSmilSourceFile = amis::FilePathTools::clearTarget(mSmilSourceFile);
 
-    //save a pointer to the smil tree that we will populate
-    mpSmilTree = pSmilTree;
-
-    //save the full path to this smil file
-    mpSmilTree->setSmilFilePath(filePath);
-
-    //set the default value for couldescape
-    mpSmilTree->setCouldEscape(false);
-
-    //remove anything from mOpenNodes NodeList
+    //remove anything from mOpenNodes NodeList, the nodes belong to a tree
     pthread_mutex_lock(&dataMutex);
-    while (mOpenNodes.size()>0)
-    {
-        delete mOpenNodes.back();
-        mOpenNodes.back() = NULL;
-        mOpenNodes.pop_back();
-    }
+    mOpenNodes.clear();
     pthread_mutex_unlock(&dataMutex);
     //remove any stored metadata
-    amis::MetaItem *tmp_ptr;
-
     while (mMetaList.size()>0)
     {
         delete mMetaList.back();
@@ -161,7 +209,8 @@ amis::AmisError SmilTreeBuilder::createSmilTree(SmilTree *pSmilTree,
     parser.setErrorHandler(this);
 
     LOG4CXX_DEBUG(amisSmilTreeBuildLog, "opening: " << tmp_string);
-    if (!parser.parseXml(tmp_string.c_str()))
+    //a head only parse is stopped on purpose when the head ends
+    if (!parser.parseXml(tmp_string.c_str()) && !(mbHeadOnly && mbHeadDone))
     {
         const XmlError *e = parser.getLastError();
         if (e)
@@ -179,8 +228,7 @@ amis::AmisError SmilTreeBuilder::createSmilTree(SmilTree *pSmilTree,
     }
 
     return mError;
-
-} //end SmilTreeBuilder::createSmilTree function
+}
 
 string SmilTreeBuilder::getMetadata(string metaname)
 {
@@ -205,6 +253,25 @@ string SmilTreeBuilder::getMetadata(string metaname)
     return null_str;
 }
 
+//--------------------------------------------------
+//get the number of metadata items read from the smil file
+//--------------------------------------------------
+unsigned int SmilTreeBuilder::getNumberOfMetaItems()
+{
+    return mMetaList.size();
+}
+
+//--------------------------------------------------
+//get a metadata item, NULL if out of range
+//--------------------------------------------------
+amis::MetaItem* SmilTreeBuilder::getMetaItem(unsigned int idx)
+{
+    if (idx >= mMetaList.size())
+        return NULL;
+
+    return mMetaList[idx];
+}
+
 //--------------------------------------------------
 /*!
  analyze the element type and collect data to build a node
@@ -230,6 +297,22 @@ bool SmilTreeBuilder::startElement(const xmlChar * uri,
 
     //cout << "SmilTreeBuilder::startElement: '" << element_name << "'" << endl; usleep(100);
 
+    //when only reading the head, stop at the body and skip everything but meta
+    if (mbHeadOnly == true)
+    {
+        if (strcmp(element_name, TAG_BODY) == 0)
+        {
+            mbHeadDone = true;
+            XmlReader::release(element_name);
+            return false;
+        }
+        else if (strcmp(element_name, TAG_META) != 0)
+        {
+            XmlReader::release(element_name);
+            return true;
+        }
+    }
+
     //large "if, else if, else" statement to match the element name
     if (strcmp(element_name, TAG_REGION) == 0)
     {
@@ -426,7 +509,7 @@ void SmilTreeBuilder::processNode(const xmlChar * qname,
             if (p_node_data->getTypeOfNode() != SEQ)
             {
                 //make a seq node for the root
-                p_root = new SeqNode();
+                p_root = mpSmilTree->getArena()->create<SeqNode>();
                 p_root->setSmilTreePtr(mpSmilTree);
                 p_root->setParent(NULL);
                 p_root->setSkipOption(empty_str);
@@ -441,6 +524,7 @@ void SmilTreeBuilder::processNode(const xmlChar * qname,
 
                 //add pNodeData as a child of the root
                 p_root->addChild(p_node_data);
+                mpSmilTree->addNodeId(p_node_data);
 
                 //if this node data is a par, add it to the open nodes list
                 //seqs also go on this list, but we have already determined this is not a seq
@@ -498,6 +582,7 @@ void SmilTreeBuilder::processNode(const xmlChar * qname,
 
             //add as the next child to the last item of the open nodes list	
             ((TimeContainerNode*) p_parent)->addChild(p_node_data);
+            mpSmilTree->addNodeId(p_node_data);
 
             //add to the open nodes list if it's a time container (par or seq)
             if (p_node_data->getCategoryOfNode() == TIME_CONTAINER)
@@ -524,6 +609,19 @@ bool SmilTreeBuilder::endElement(const xmlChar * uri, const xmlChar * localname,
     //local variable
     const char* element_name = XmlReader::transcode(qname);
 
+    //the head has ended, no need to read any further
+    if (mbHeadOnly == true)
+    {
+        if (strcmp(element_name, TAG_HEAD) == 0)
+        {
+            mbHeadDone = true;
+            XmlReader::release(element_name);
+            return false;
+        }
+        XmlReader::release(element_name);
+        return true;
+    }
+
     //if this element is a seq or par, then remove the last item from the openNodes list
     //since the element is being ended, we will not want to add children to it
     if (strcmp(element_name, TAG_SEQ) == 0
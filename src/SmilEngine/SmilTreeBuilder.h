@@ -65,9 +65,15 @@ public:
     //METHODS
     //!main method to create a smil tree from a filepath
     amis::AmisError createSmilTree(SmilTree*, std::string);
+    //!read only the metadata in the head of a smil file
+    amis::AmisError readSmilHead(std::string);
 
     //!find metadata in smil file
     std::string getMetadata(std::string);
+    //!get the number of metadata items in smil file
+    unsigned int getNumberOfMetaItems();
+    //!get a metadata item in smil file
+    amis::MetaItem* getMetaItem(unsigned int);
 
     //SAX METHODS
     //!xmlreader start element event
@@ -92,6 +98,8 @@ private:
     void processNode(const xmlChar* const, const XmlAttributes&);
     //!process a layout region element
     void processRegion(const xmlChar* const, const XmlAttributes&);
+    //!clear the builder state and parse a file
+    amis::AmisError parseFile(std::string);
 
     //MEMBER VARIABLES
 
@@ -122,6 +130,11 @@ private:
     //!the source file path
     std::string mSmilSourceFile;
 
+    //!are we only reading the head?
+    bool mbHeadOnly;
+    //!has the end of the head been reached?
+    bool mbHeadDone;
+
     //!build error
     amis::ErrorCode mBuildErrorFlag;
     //!build error message
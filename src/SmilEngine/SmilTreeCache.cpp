@@ -0,0 +1,338 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+//SYSTEM INCLUDES
+#include <string>
+#include <list>
+
+//PROJECT INCLUDES
+#include "Media.h"
+#include "SmilEngineConstants.h"
+#include "SmilTree.h"
+#include "Node.h"
+#include "TimeContainerNode.h"
+#include "ContentNode.h"
+#include "SmilTreeCache.h"
+
+#include <log4cxx/logger.h>
+
+// create logger which will become a child to logger kolibre.amis
+log4cxx::LoggerPtr amisSmilTreeCacheLog(
+        log4cxx::Logger::getLogger("kolibre.amis.smiltreecache"));
+
+using namespace std;
+
+//--------------------------------------------------
+//Default constructor
+//--------------------------------------------------
+SmilTreeCache::SmilTreeCache()
+{
+    mMaxTrees = CACHE_MAX_TREES;
+    mMaxMemory = CACHE_MAX_MEMORY;
+    mMemoryUsage = 0;
+    mHits = 0;
+    mMisses = 0;
+    pthread_mutex_init(&mCacheMutex, NULL);
+}
+
+//--------------------------------------------------
+//Destructor
+//--------------------------------------------------
+SmilTreeCache::~SmilTreeCache()
+{
+    clear();
+    pthread_mutex_destroy(&mCacheMutex);
+}
+
+//--------------------------------------------------
+/*!
+ Store a tree as the most recently used one. A tree already cached for the
+ same path is replaced. Trees are deleted from the end of the list until the
+ cache is within its bounds, which may include the tree just stored.
+ */
+//--------------------------------------------------
+void SmilTreeCache::put(SmilTree* pTree)
+{
+    if (pTree == NULL)
+        return;
+
+    CacheEntry entry;
+    entry.mPath = pTree->getSmilFilePath();
+    entry.mpTree = pTree;
+    entry.mSize = sizeof(SmilTree) + pTree->getArena()->getMemoryUsage()
+            + estimateSize(pTree->getRoot());
+
+    pthread_mutex_lock(&mCacheMutex);
+
+    //drop an older copy of the same file
+    SmilTree* p_old = remove(entry.mPath);
+    if (p_old != NULL && p_old != pTree)
+        delete p_old;
+
+    mEntries.push_front(entry);
+    mMemoryUsage += entry.mSize;
+
+    LOG4CXX_DEBUG(amisSmilTreeCacheLog,
+            "Cached " << entry.mPath << " (" << entry.mSize << " bytes), " << mEntries.size() << " trees, " << mMemoryUsage << " bytes");
+
+    evict();
+
+    pthread_mutex_unlock(&mCacheMutex);
+}
+
+//--------------------------------------------------
+/*!
+ Remove the tree for a smil file from the cache.
+ @return the tree, owned by the caller, or NULL if it was not cached
+ */
+//--------------------------------------------------
+SmilTree* SmilTreeCache::take(string path)
+{
+    pthread_mutex_lock(&mCacheMutex);
+
+    SmilTree* p_tree = remove(path);
+
+    if (p_tree != NULL)
+    {
+        mHits++;
+        LOG4CXX_DEBUG(amisSmilTreeCacheLog, "Hit for " << path);
+    }
+    else
+    {
+        mMisses++;
+        LOG4CXX_DEBUG(amisSmilTreeCacheLog, "Miss for " << path);
+    }
+
+    pthread_mutex_unlock(&mCacheMutex);
+
+    return p_tree;
+}
+
+//--------------------------------------------------
+//delete all cached trees
+//--------------------------------------------------
+void SmilTreeCache::clear()
+{
+    pthread_mutex_lock(&mCacheMutex);
+    while (mEntries.size() > 0)
+    {
+        delete mEntries.back().mpTree;
+        mEntries.pop_back();
+    }
+    mMemoryUsage = 0;
+    pthread_mutex_unlock(&mCacheMutex);
+}
+
+//--------------------------------------------------
+//reset the hit and miss counters
+//--------------------------------------------------
+void SmilTreeCache::resetCounters()
+{
+    pthread_mutex_lock(&mCacheMutex);
+    mHits = 0;
+    mMisses = 0;
+    pthread_mutex_unlock(&mCacheMutex);
+}
+
+//--------------------------------------------------
+//set the maximum number of cached trees
+//--------------------------------------------------
+void SmilTreeCache::setMaxTrees(unsigned int maxTrees)
+{
+    pthread_mutex_lock(&mCacheMutex);
+    mMaxTrees = maxTrees;
+    evict();
+    pthread_mutex_unlock(&mCacheMutex);
+}
+
+//--------------------------------------------------
+//get the maximum number of cached trees
+//--------------------------------------------------
+unsigned int SmilTreeCache::getMaxTrees()
+{
+    return mMaxTrees;
+}
+
+//--------------------------------------------------
+//set the maximum estimated memory use
+//--------------------------------------------------
+void SmilTreeCache::setMaxMemory(unsigned long maxMemory)
+{
+    pthread_mutex_lock(&mCacheMutex);
+    mMaxMemory = maxMemory;
+    evict();
+    pthread_mutex_unlock(&mCacheMutex);
+}
+
+//--------------------------------------------------
+//get the maximum estimated memory use
+//--------------------------------------------------
+unsigned long SmilTreeCache::getMaxMemory()
+{
+    return mMaxMemory;
+}
+
+//--------------------------------------------------
+//get the number of cached trees
+//--------------------------------------------------
+unsigned int SmilTreeCache::getNumberOfTrees()
+{
+    pthread_mutex_lock(&mCacheMutex);
+    unsigned int value = mEntries.size();
+    pthread_mutex_unlock(&mCacheMutex);
+    return value;
+}
+
+//--------------------------------------------------
+//get the estimated memory used by the cached trees
+//--------------------------------------------------
+unsigned long SmilTreeCache::getMemoryUsage()
+{
+    pthread_mutex_lock(&mCacheMutex);
+    unsigned long value = mMemoryUsage;
+    pthread_mutex_unlock(&mCacheMutex);
+    return value;
+}
+
+//--------------------------------------------------
+//get the number of hits
+//--------------------------------------------------
+unsigned long SmilTreeCache::getHits()
+{
+    pthread_mutex_lock(&mCacheMutex);
+    unsigned long value = mHits;
+    pthread_mutex_unlock(&mCacheMutex);
+    return value;
+}
+
+//--------------------------------------------------
+//get the number of misses
+//--------------------------------------------------
+unsigned long SmilTreeCache::getMisses()
+{
+    pthread_mutex_lock(&mCacheMutex);
+    unsigned long value = mMisses;
+    pthread_mutex_unlock(&mCacheMutex);
+    return value;
+}
+
+//--------------------------------------------------
+//is a tree cached for a smil file?
+//--------------------------------------------------
+bool SmilTreeCache::isCached(string path)
+{
+    bool b_found = false;
+
+    pthread_mutex_lock(&mCacheMutex);
+    list<CacheEntry>::iterator it;
+    for (it = mEntries.begin(); it != mEntries.end(); it++)
+    {
+        if (it->mPath.compare(path) == 0)
+        {
+            b_found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&mCacheMutex);
+
+    return b_found;
+}
+
+//--------------------------------------------------
+//remove a tree from the list without counting a lookup
+//--------------------------------------------------
+SmilTree* SmilTreeCache::remove(string path)
+{
+    list<CacheEntry>::iterator it;
+    for (it = mEntries.begin(); it != mEntries.end(); it++)
+    {
+        if (it->mPath.compare(path) == 0)
+        {
+            SmilTree* p_tree = it->mpTree;
+            mMemoryUsage -= it->mSize;
+            mEntries.erase(it);
+            return p_tree;
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------
+//delete least recently used trees until within bounds
+//--------------------------------------------------
+void SmilTreeCache::evict()
+{
+    while (mEntries.size() > 0
+            && (mEntries.size() > mMaxTrees
+                    || (mMaxMemory > 0 && mMemoryUsage > mMaxMemory)))
+    {
+        LOG4CXX_DEBUG(amisSmilTreeCacheLog,
+                "Evicting " << mEntries.back().mPath);
+        mMemoryUsage -= mEntries.back().mSize;
+        delete mEntries.back().mpTree;
+        mEntries.pop_back();
+    }
+}
+
+//--------------------------------------------------
+/*!
+ Estimate the heap memory used by the strings of a node, its media and its
+ children. The objects themselves are in the node arena of the tree.
+ */
+//--------------------------------------------------
+unsigned long SmilTreeCache::estimateSize(Node* pNode)
+{
+    if (pNode == NULL)
+        return 0;
+
+    unsigned long size = pNode->getElementId().size();
+
+    if (pNode->getCategoryOfNode() == TIME_CONTAINER)
+    {
+        TimeContainerNode* p_container = (TimeContainerNode*) pNode;
+        size += p_container->getSkipOption().size();
+
+        Node* p_child = p_container->getChild(0);
+        while (p_child != NULL)
+        {
+            size += estimateSize(p_child);
+            p_child = p_child->getFirstSibling();
+        }
+        return size;
+    }
+
+    amis::MediaNode* p_media = ((ContentNode*) pNode)->getMediaNode();
+    if (p_media == NULL)
+        return size;
+
+    //audio and image srcs and the region id are in the string pool, shared by all trees
+    size += p_media->getId().size() + p_media->getHref().size();
+    if (p_media->getMediaNodeType() == amis::TEXT)
+        size += p_media->getSrc().size();
+
+    if (pNode->getTypeOfNode() == AUD)
+    {
+        amis::AudioNode* p_audio = (amis::AudioNode*) p_media;
+        size += p_audio->getClipBegin().size() + p_audio->getClipEnd().size();
+    }
+
+    return size;
+}
@@ -0,0 +1,121 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SMILTREECACHE_H
+#define SMILTREECACHE_H
+
+//SYSTEM INCLUDES
+#include <string>
+#include <list>
+#include <pthread.h>
+
+class Node;
+class SmilTree;
+
+//! The Smil Tree Cache keeps recently used smil trees in memory
+/*!
+ Trees are keyed by their smil file path and kept in least recently used
+ order. The cache is bounded both by the number of trees and by an estimate
+ of the memory they use, the least recently used tree is deleted first.
+
+ A tree is owned by the cache while it is stored. take() hands the tree back
+ to the caller, who must either delete it or put() it back. All methods may
+ be called from several threads.
+ */
+class SmilTreeCache
+{
+
+public:
+    //LIFECYCLE
+    //!default constructor
+    SmilTreeCache();
+    //!destructor
+    ~SmilTreeCache();
+
+    //METHODS
+    //!store a tree, the cache takes ownership
+    void put(SmilTree*);
+    //!remove a tree from the cache and return it, NULL if not cached
+    SmilTree* take(std::string);
+    //!delete all cached trees
+    void clear();
+    //!reset the hit and miss counters
+    void resetCounters();
+
+    //ACCESS
+    //!set the maximum number of cached trees, 0 disables the cache
+    void setMaxTrees(unsigned int);
+    //!get the maximum number of cached trees
+    unsigned int getMaxTrees();
+    //!set the maximum estimated memory use in bytes, 0 means no limit
+    void setMaxMemory(unsigned long);
+    //!get the maximum estimated memory use in bytes
+    unsigned long getMaxMemory();
+    //!get the number of cached trees
+    unsigned int getNumberOfTrees();
+    //!get the estimated memory used by the cached trees
+    unsigned long getMemoryUsage();
+    //!get the number of lookups that found a tree
+    unsigned long getHits();
+    //!get the number of lookups that did not find a tree
+    unsigned long getMisses();
+
+    //INQUIRY
+    //!is a tree cached for a smil file? does not count as a lookup
+    bool isCached(std::string);
+
+private:
+    //!a cached tree
+    struct CacheEntry
+    {
+        //!smil file path
+        std::string mPath;
+        //!the tree
+        SmilTree* mpTree;
+        //!estimated size of the tree in bytes
+        unsigned long mSize;
+    };
+
+    //METHODS
+    //!remove a tree from the list without counting a lookup
+    SmilTree* remove(std::string);
+    //!delete trees until the cache is within its bounds
+    void evict();
+    //!estimate the memory used by the strings of a node and its children
+    unsigned long estimateSize(Node*);
+
+    //MEMBER VARIABLES
+    //!cached trees, most recently used first
+    std::list<CacheEntry> mEntries;
+    //!maximum number of trees
+    unsigned int mMaxTrees;
+    //!maximum estimated memory use
+    unsigned long mMaxMemory;
+    //!estimated memory use
+    unsigned long mMemoryUsage;
+    //!number of hits
+    unsigned long mHits;
+    //!number of misses
+    unsigned long mMisses;
+    //!protects the entries and the counters
+    pthread_mutex_t mCacheMutex;
+};
+
+#endif
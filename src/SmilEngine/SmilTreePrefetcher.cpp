@@ -0,0 +1,259 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+//SYSTEM INCLUDES
+#include <string>
+#include <deque>
+
+//PROJECT INCLUDES
+#include "AmisError.h"
+#include "SmilTree.h"
+#include "SmilTreeBuilder.h"
+#include "SmilTreeCache.h"
+#include "SmilTreePrefetcher.h"
+
+#include <log4cxx/logger.h>
+
+// create logger which will become a child to logger kolibre.amis
+log4cxx::LoggerPtr amisSmilTreePrefetchLog(
+        log4cxx::Logger::getLogger("kolibre.amis.smiltreeprefetcher"));
+
+using namespace std;
+
+//--------------------------------------------------
+//worker thread entry point
+//--------------------------------------------------
+void *prefetch_thread(void *prefetcher)
+{
+    ((SmilTreePrefetcher *) prefetcher)->run();
+    return NULL;
+}
+
+//--------------------------------------------------
+//Constructor
+//--------------------------------------------------
+SmilTreePrefetcher::SmilTreePrefetcher(SmilTreeCache* pCache)
+{
+    mpCache = pCache;
+    mpBuilder = new SmilTreeBuilder();
+    mDaisyVersion = 0;
+    mNumBuilt = 0;
+    mbStop = false;
+    mbThreadActive = false;
+    pthread_mutex_init(&mMutex, NULL);
+    pthread_cond_init(&mCond, NULL);
+}
+
+//--------------------------------------------------
+//Destructor
+//--------------------------------------------------
+SmilTreePrefetcher::~SmilTreePrefetcher()
+{
+    stop();
+    delete mpBuilder;
+    pthread_cond_destroy(&mCond);
+    pthread_mutex_destroy(&mMutex);
+}
+
+//--------------------------------------------------
+/*!
+ Queue a smil file to be built on the worker thread. Files that are already
+ cached, queued or being built are ignored.
+ @param[in] path
+ full path to the smil file
+ @param[in] daisyVersion
+ DAISY202 or DAISY3
+ */
+//--------------------------------------------------
+void SmilTreePrefetcher::request(string path, int daisyVersion)
+{
+    if (path.empty() || mpCache->isCached(path))
+        return;
+
+    pthread_mutex_lock(&mMutex);
+
+    if (mBuildingPath.compare(path) == 0)
+    {
+        pthread_mutex_unlock(&mMutex);
+        return;
+    }
+
+    for (unsigned int i = 0; i < mPending.size(); i++)
+    {
+        if (mPending[i].compare(path) == 0)
+        {
+            pthread_mutex_unlock(&mMutex);
+            return;
+        }
+    }
+
+    LOG4CXX_DEBUG(amisSmilTreePrefetchLog, "Queueing " << path);
+    mPending.push_back(path);
+    mDaisyVersion = daisyVersion;
+
+    if (mbThreadActive == false)
+    {
+        mbStop = false;
+        if (pthread_create(&mThread, NULL, prefetch_thread, this) == 0)
+        {
+            mbThreadActive = true;
+        }
+        else
+        {
+            LOG4CXX_WARN(amisSmilTreePrefetchLog,
+                    "Failed to start prefetch thread");
+            mPending.clear();
+        }
+    }
+
+    pthread_cond_broadcast(&mCond);
+    pthread_mutex_unlock(&mMutex);
+}
+
+//--------------------------------------------------
+/*!
+ Called before a smil file is loaded for playback. A queued request for the
+ file is dropped, since the caller is about to build it anyway, and if the
+ worker is building the file we wait for it to land in the cache.
+ */
+//--------------------------------------------------
+void SmilTreePrefetcher::release(string path)
+{
+    pthread_mutex_lock(&mMutex);
+
+    deque<string>::iterator it;
+    for (it = mPending.begin(); it != mPending.end(); it++)
+    {
+        if (it->compare(path) == 0)
+        {
+            mPending.erase(it);
+            break;
+        }
+    }
+
+    while (mBuildingPath.compare(path) == 0)
+    {
+        LOG4CXX_DEBUG(amisSmilTreePrefetchLog, "Waiting for " << path);
+        pthread_cond_wait(&mCond, &mMutex);
+    }
+
+    pthread_mutex_unlock(&mMutex);
+}
+
+//--------------------------------------------------
+/*!
+ Drop all queued requests, let a running build finish and join the worker.
+ Must be called before the cache or the book is cleared.
+ */
+//--------------------------------------------------
+void SmilTreePrefetcher::stop()
+{
+    pthread_mutex_lock(&mMutex);
+    mPending.clear();
+    mbStop = true;
+    bool b_join = mbThreadActive;
+    mbThreadActive = false;
+    pthread_cond_broadcast(&mCond);
+    pthread_mutex_unlock(&mMutex);
+
+    if (b_join)
+    {
+        LOG4CXX_DEBUG(amisSmilTreePrefetchLog, "Joining prefetch thread");
+        pthread_join(mThread, NULL);
+    }
+}
+
+//--------------------------------------------------
+//get the number of trees built by the worker
+//--------------------------------------------------
+unsigned long SmilTreePrefetcher::getNumberOfBuiltTrees()
+{
+    pthread_mutex_lock(&mMutex);
+    unsigned long value = mNumBuilt;
+    pthread_mutex_unlock(&mMutex);
+    return value;
+}
+
+//--------------------------------------------------
+//have all requested trees been built?
+//--------------------------------------------------
+bool SmilTreePrefetcher::isIdle()
+{
+    pthread_mutex_lock(&mMutex);
+    bool value = mPending.size() == 0 && mBuildingPath.empty();
+    pthread_mutex_unlock(&mMutex);
+    return value;
+}
+
+//--------------------------------------------------
+//take requests off the queue and build them until stopped
+//--------------------------------------------------
+void SmilTreePrefetcher::run()
+{
+    pthread_mutex_lock(&mMutex);
+
+    while (true)
+    {
+        while (mPending.size() == 0 && mbStop == false)
+        {
+            pthread_cond_wait(&mCond, &mMutex);
+        }
+
+        if (mbStop == true)
+            break;
+
+        mBuildingPath = mPending.front();
+        mPending.pop_front();
+        string path = mBuildingPath;
+        int daisy_version = mDaisyVersion;
+
+        pthread_mutex_unlock(&mMutex);
+
+        bool b_built = false;
+        if (mpCache->isCached(path) == false)
+        {
+            LOG4CXX_DEBUG(amisSmilTreePrefetchLog, "Building " << path);
+
+            SmilTree* p_tree = new SmilTree();
+            mpBuilder->setDaisyVersion(daisy_version);
+            amis::AmisError err = mpBuilder->createSmilTree(p_tree, path);
+
+            if (err.getCode() == amis::OK)
+            {
+                mpCache->put(p_tree);
+                b_built = true;
+            }
+            else
+            {
+                LOG4CXX_WARN(amisSmilTreePrefetchLog,
+                        "Failed to build " << path << ": " << err.getMessage());
+                delete p_tree;
+            }
+        }
+
+        pthread_mutex_lock(&mMutex);
+        if (b_built)
+            mNumBuilt++;
+        mBuildingPath = "";
+        pthread_cond_broadcast(&mCond);
+    }
+
+    pthread_mutex_unlock(&mMutex);
+}
@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SMILTREEPREFETCHER_H
+#define SMILTREEPREFETCHER_H
+
+//SYSTEM INCLUDES
+#include <string>
+#include <deque>
+#include <pthread.h>
+
+class SmilTreeBuilder;
+class SmilTreeCache;
+
+void *prefetch_thread(void *);
+
+//! The Smil Tree Prefetcher builds smil trees ahead of playback
+/*!
+ Requested smil files are parsed one at a time on a worker thread and the
+ finished trees are stored in a SmilTreeCache, where the Smil Engine finds
+ them when playback crosses into the next file.
+
+ The worker thread is started by the first request and runs until stop().
+ */
+class SmilTreePrefetcher
+{
+
+public:
+    //LIFECYCLE
+    //!constructor, trees are stored in the given cache
+    SmilTreePrefetcher(SmilTreeCache*);
+    //!destructor
+    ~SmilTreePrefetcher();
+
+    //METHODS
+    //!queue a smil file to be built
+    void request(std::string, int);
+    //!make sure the worker is not building a smil file
+    void release(std::string);
+    //!drop all requests and stop the worker thread
+    void stop();
+
+    //ACCESS
+    //!get the number of trees built by the worker
+    unsigned long getNumberOfBuiltTrees();
+
+    //INQUIRY
+    //!have all requested trees been built?
+    bool isIdle();
+
+private:
+    //METHODS
+    //!build requested trees until stopped
+    void run();
+
+    //MEMBER VARIABLES
+    //!where the trees are stored
+    SmilTreeCache* mpCache;
+    //!the tree builder used by the worker
+    SmilTreeBuilder* mpBuilder;
+    //!smil files waiting to be built
+    std::deque<std::string> mPending;
+    //!smil file being built
+    std::string mBuildingPath;
+    //!daisy version of the book
+    int mDaisyVersion;
+    //!number of trees built
+    unsigned long mNumBuilt;
+    //!stop flag
+    bool mbStop;
+
+    //!the worker thread
+    pthread_t mThread;
+    //!is the worker thread running?
+    bool mbThreadActive;
+    //!protects the requests and the flags
+    pthread_mutex_t mMutex;
+    //!signals new requests and finished builds
+    pthread_cond_t mCond;
+
+    friend void *prefetch_thread(void *);
+};
+
+#endif
@@ -29,7 +29,6 @@
 #include <string>
 #include <iostream>
 #include <algorithm>
-#include <cstring>
 #include <log4cxx/logger.h>
 
 // create logger which will become a child to logger kolibre.amis
@@ -42,7 +41,7 @@ using namespace std;
 //Default constructor
 //--------------------------------------------------
 Spine::Spine() :
-        mSpineList()
+        mSpineList(), mFileIndex()
 {
     //initialize variables
     mListIndex = 0;
@@ -141,27 +140,7 @@ amis::ErrorCode Spine::getStatus()
 //--------------------------------------------------
 bool Spine::isFilePresent(const string filePath)
 {
-    // Special case if mSpineList is empty
-    if (mSpineList.size() == 0)
-        return false;
-
-    //local variables
-    bool b_exists = false;
-    const char *file_to_compare = amis::FilePathTools::getAsLocalFilePath(
-            filePath).c_str();
-    string file_in_list;
-
-    //for-loop through the spine list from beginning to end
-    for (int i = mSpineList.size() - 1; i >= 0; i--)
-    {
-        if (strstr(file_to_compare, mSpineList[i]) != NULL)
-        {
-            b_exists = true;
-            break;
-        }
-    } //! end for-loop
-
-    return b_exists;
+    return mFileIndex.find(normalizePath(filePath)) != mFileIndex.end();
 }
 
 //--------------------------------------------------
@@ -173,11 +152,10 @@ void Spine::addFile(string filePath)
     //LOG4CXX_DEBUG(amisSpineLog, "Spine::addFile() " << filePath);
 
     //if the file doesn't already exist, add it to the spine list
-    if (isFilePresent(filePath) == false)
+    unsigned int idx = mSpineList.size();
+    if (mFileIndex.insert(make_pair(normalizePath(filePath), idx)).second)
     {
-        filePath = amis::FilePathTools::clearTarget(filePath);
-        char *path = strdup(filePath.c_str());
-        mSpineList.push_back(path);
+        mSpineList.push_back(amis::FilePathTools::clearTarget(filePath));
     }
 }
 
@@ -213,19 +191,8 @@ bool Spine::isEmpty()
 //--------------------------------------------------
 void Spine::freeSpineList()
 {
-    //remove anything from mSpineList char* list
-    char* tmp = NULL;
-    //cout << "Starting freeing spinelist with " << mSpineList.size() << " items" << endl;
-
-    while (mSpineList.size() > 0)
-    {
-        tmp = mSpineList[mSpineList.size() - 1];
-        //cout << "Freeing item " << mSpineList.size() - 1 << " '" << tmp << "'" <<endl;
-        if (tmp != NULL)
-            free((void *) tmp);
-        mSpineList.pop_back();
-
-    }
+    mSpineList.clear();
+    mFileIndex.clear();
 }
 
 //--------------------------------------------------
@@ -233,35 +200,30 @@ void Spine::freeSpineList()
 //--------------------------------------------------
 bool Spine::goToFile(string filePath)
 {
-    string file_to_compare = amis::FilePathTools::getAsLocalFilePath(filePath);
-    string file_in_list;
-    bool b_found = false;
+    tr1::unordered_map<string, unsigned int>::const_iterator it =
+            mFileIndex.find(normalizePath(filePath));
 
-    //convert to lower case
-    std::transform(file_to_compare.begin(), file_to_compare.end(),
-            file_to_compare.begin(), (int (*)(int))tolower);
+    if (it == mFileIndex.end())
+        return false;
 
-            //for-loop through the spine list from beginning to end
-for(    unsigned int i=0; i<mSpineList.size(); i++)
-    {
-        //get the file in the list in its local file path form
-        file_in_list = amis::FilePathTools::getAsLocalFilePath(mSpineList[i]);
-
-        //convert to lower case
-        std::transform(file_in_list.begin(), file_in_list.end(),
-        file_in_list.begin(), (int(*)(int))tolower);
-
-        //compare the filepaths and see if they are equal
-        if (file_in_list.compare(file_to_compare) == 0)
-        {
-            b_found = true;
-            mListIndex = i;
-            mStatus = amis::OK;
-            break;
-        }
-    } //! end for-loop
-
-    return b_found;
+    mListIndex = it->second;
+    mStatus = amis::OK;
+    return true;
+}
+
+//--------------------------------------------------
+//the path with forward slashes, no target and in lower case, the target is
+//stripped by clearTarget so the key matches the path kept in the list
+//--------------------------------------------------
+string Spine::normalizePath(const string& filePath)
+{
+    string key = amis::FilePathTools::convertSlashesFwd(
+            amis::FilePathTools::clearTarget(filePath));
+
+    std::transform(key.begin(), key.end(), key.begin(),
+            (int (*)(int))tolower);
+
+    return key;
 }
 
 //--------------------------------------------------
@@ -287,3 +249,10 @@ string Spine::getSmilFilePath(unsigned int idx)
     }
 }
 
+//--------------------------------------------------
+//get the index of the current file in the list
+//--------------------------------------------------
+unsigned int Spine::getCurrentIndex()
+{
+    return mListIndex;
+}
@@ -25,6 +25,7 @@
 //SYSTEM INCLUDES
 #include <string>
 #include <vector>
+#include <tr1/unordered_map>
 
 //PROJECT INCLUDES
 
@@ -32,7 +33,8 @@
 
 /*!
  The Spine keeps track of the in-order list of all SMIL files that 
- make up a Daisy book.
+ make up a Daisy book. Files are looked up by their path without target,
+ compared with forward slashes and without regard to case.
  */
 class Spine
 {
@@ -75,11 +77,19 @@ public:
     int getNumberOfSmilFiles();
     //!get the filepath of a SMIL file
     std::string getSmilFilePath(unsigned int);
+    //!get the index of the current file
+    unsigned int getCurrentIndex();
 
 private:
+    //METHODS
+    //!get the key of a file in the index
+    static std::string normalizePath(const std::string&);
+
     //MEMBER VARIABLES
     //!the file list
-    std::vector<char *> mSpineList;
+    std::vector<std::string> mSpineList;
+    //!position of each file in the list, by normalized path
+    std::tr1::unordered_map<std::string, unsigned int> mFileIndex;
     //!the current list index
     unsigned int mListIndex;
     //!the status
@@ -26,6 +26,7 @@
 #include <cctype>
 #include <algorithm>
 #include <cstring>
+#include <tr1/unordered_map>
 
 //PROJECT INCLUDES
 #include "AmisCommon.h"
@@ -501,30 +502,26 @@ void SpineBuilder::sortOpfSpine()
 {
     //local variables
     unsigned int i;
-    unsigned int j;
-    string search_id;
+    tr1::unordered_map<string, unsigned int> manifest_index;
+    tr1::unordered_map<string, unsigned int>::const_iterator it;
 
     //LOG4CXX_DEBUG(amisSpineBuilderLog, "Sorting Opf spine");
 
+    //index the manifest by id, the first item with an id wins
+    for (i = 0; i < mOpfManifest.size(); i++)
+    {
+        manifest_index.insert(make_pair(mOpfManifest[i].mId, i));
+    }
+
     //for-loop through the opf spine list
     for (i = 0; i < mOpfSpine.size(); i++)
     {
-        search_id = mOpfSpine[i];
-
-        //for-loop through the manifest list
-        for (j = 0; j < mOpfManifest.size(); j++)
+        //if the id is in the manifest, add this Smil file path to our master spine list
+        it = manifest_index.find(mOpfSpine[i]);
+        if (it != manifest_index.end())
         {
-
-            //LOG4CXX_DEBUG(amisSpineBuilderLog, "Searching for id " << search_id << " in " << mOpfManifest[j].mId);
-
-            //if the ids match, then add this Smil file path to our master spine list
-            if (mOpfManifest[j].mId == search_id)
-            {
-
-                mpSpine->addFile(mOpfManifest[j].mFileHref);
-                break;
-            }
-        } //end for-loop through manifest
+            mpSpine->addFile(mOpfManifest[it->second].mFileHref);
+        }
 
     } //end for-loop through opf spine list
 
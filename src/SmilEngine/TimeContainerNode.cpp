@@ -39,65 +39,41 @@ using namespace std;
 //--------------------------------------------------
 TimeContainerNode::TimeContainerNode()
 {
-    mNumChildren = 0;
-    mpFirstChild = NULL;
     mSkipOptionName = "";
 }
 
 //--------------------------------------------------
 //Destructor
 /*!
- delete all children recursively
+ the children are owned by the node arena of the tree, not by this node
  */
 //--------------------------------------------------
 TimeContainerNode::~TimeContainerNode()
 {
-    Node* p_tmp_node;
-
-    //if this node has no children, perform any internal cleanup and return
-    if (mpFirstChild == NULL)
-    {
-        return;
-    }
-
-    //else, this node has one or more children
-    else
-    {
-        //loop through the children and delete one by one
-        while (mNumChildren > 0)
-        {
-            p_tmp_node = getChild(mNumChildren - 1);
-            delete p_tmp_node;
-
-            //each time a child is deleted, decrement the number of children
-            mNumChildren--;
-        }
-    }
+    //empty function
 }
 
 //--------------------------------------------------
 //add a child to this time container node
+/*!
+ children are kept in an array for indexed access, the sibling links are
+ kept as well for code that walks the children as a list
+ */
 //--------------------------------------------------
 void TimeContainerNode::addChild(Node* pNode)
 {
-    //check if first child does not exist
-    if (mNumChildren == 0 || mpFirstChild == NULL)
+    //link the new node after the current last child
+    if (mChildren.size() == 0)
     {
-        //set new node pointer as first child
-        mpFirstChild = pNode;
-
-        //set the new child's parent to be this node
-        mpFirstChild->setParent(this);
-
-        mNumChildren++;
+        pNode->setParent(this);
     }
-
-    //if exists, add new node pointer as a sibling
     else
     {
-        mpFirstChild->addSibling(pNode);
-        mNumChildren++;
+        mChildren.back()->addSibling(pNode);
     }
+
+    pNode->setIndexInParent(mChildren.size());
+    mChildren.push_back(pNode);
 }
 
 //--------------------------------------------------
@@ -125,24 +101,10 @@ string TimeContainerNode::getSkipOption()
 //--------------------------------------------------
 Node* TimeContainerNode::getChild(int index)
 {
-    //local variables
-    Node* p_tmp_node;
-
     //check the bounds of the requested index
-    if (index < mNumChildren && index >= 0)
+    if (index < (int) mChildren.size() && index >= 0)
     {
-        //initialize the temp variable to the first child pointer
-        //we can assume it exists because of the if-statement conditions
-        p_tmp_node = mpFirstChild;
-
-        //for-loop to iterate through the sibling list until we get to the node at index-1
-        for (int i = 0; i < index; i++)
-        {
-            p_tmp_node = p_tmp_node->getFirstSibling();
-        }
-
-        //return a pointer to the requested child
-        return p_tmp_node;
+        return mChildren[index];
     }
 
     else
@@ -158,7 +120,7 @@ Node* TimeContainerNode::getChild(int index)
 //--------------------------------------------------
 int TimeContainerNode::NumChildren()
 {
-    return mNumChildren;
+    return mChildren.size();
 }
 
 //--------------------------------------------------
@@ -23,6 +23,9 @@
 #ifndef TIMECONTAINERNODE_H
 #define TIMECONTAINERNODE_H
 
+//SYSTEM INCLUDES
+#include <vector>
+
 //PROJECT INCLUDES
 #include "Node.h"
 #include "SmilEngineConstants.h"
@@ -72,10 +75,8 @@ public:
 
 private:
     //MEMBER VARIABLES
-    //!pointer to first child
-    Node* mpFirstChild;
-    //!number of children
-    int mNumChildren;
+    //!the children in document order
+    std::vector<Node*> mChildren;
     //!skippability option name if exists
     std::string mSkipOptionName;
 };
@@ -48,6 +48,8 @@ bool findSmilAt( unsigned int seconds )
                 {
                     // We found the smil file covering seconds
                     std::cout << "Smil file: " << search.getCurrentSmilPath() << " contains " << seconds << " seconds position" << std::endl;
+                    // The probes only read the head, the tree is built on demand
+                    assert( search.getCurrentSmilTree() != NULL );
                     return true;
                 }
 
@@ -63,6 +65,28 @@ bool findSmilAt( unsigned int seconds )
     return false;
 }
 
+void compareHeadWithTree( std::string smilPath )
+{
+    std::cout << __PRETTY_FUNCTION__ << std::endl;
+
+    SmilTreeBuilder headBuilder;
+    headBuilder.setDaisyVersion( SmilEngine::Instance()->getDaisyVersion() );
+    assert( headBuilder.readSmilHead( smilPath ).getCode() == amis::OK );
+
+    SmilTreeBuilder treeBuilder;
+    SmilTree tree;
+    treeBuilder.setDaisyVersion( SmilEngine::Instance()->getDaisyVersion() );
+    assert( treeBuilder.createSmilTree( &tree, smilPath ).getCode() == amis::OK );
+
+    // A head only parse must find the same metadata as a full parse
+    assert( headBuilder.getNumberOfMetaItems() == treeBuilder.getNumberOfMetaItems() );
+    for( unsigned int i = 0; i < headBuilder.getNumberOfMetaItems(); i++ )
+    {
+        assert( headBuilder.getMetaItem( i )->mName == treeBuilder.getMetaItem( i )->mName );
+        assert( headBuilder.getMetaItem( i )->mContent == treeBuilder.getMetaItem( i )->mContent );
+    }
+}
+
 int main(int argc, char *argv[])
 {
     if(argc < 2) {
@@ -77,11 +101,7 @@ int main(int argc, char *argv[])
         exit(1);
     }
 
-    while(DaisyHandler::Instance()->getState() == DaisyHandler::HANDLER_OPENING) {
-        usleep(1000);
-    }
-
-    if(DaisyHandler::Instance()->getState() != DaisyHandler::HANDLER_OPEN) {
+    if(DaisyHandler::Instance()->waitForOpen() != DaisyHandler::HANDLER_OPEN) {
         std::cout << "The file " << argv[1] << " could not be open, please check for errors" << std::endl;
         DaisyHandler::Instance()->DestroyInstance();
         return 1;
@@ -131,6 +151,12 @@ int main(int argc, char *argv[])
     std::cout << "*****************************************************************" << std::endl;
     assert( findSmilAt( seconds ) ); // slutet
 
+    std::cout << "*****************************************************************" << std::endl;
+    std::cout << " Test: " << test++ << ", read smil heads" << std::endl;
+    std::cout << "*****************************************************************" << std::endl;
+    compareHeadWithTree( SmilEngine::Instance()->getSmilFilePath( 0 ) );
+    compareHeadWithTree( SmilEngine::Instance()->getSmilFilePath( SmilEngine::Instance()->getNumberOfSmilFiles() - 1 ) );
+
     // Test jumping to positions inside book
     std::cout << "*****************************************************************" << std::endl;
     std::cout << " Test: " << test++ << ", jump to: " << seconds/10 << " [Inside]" << std::endl;
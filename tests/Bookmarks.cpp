@@ -25,6 +25,7 @@
 
 #include "BookmarksWriter.h"
 #include "BookmarksReader.h"
+#include "LastmarkWriter.h"
 #include "setup_logging.h"
 
 using namespace amis;
@@ -55,6 +56,18 @@ void saveBookmark(std::string bookmarkFile, BookmarkFile* pBmk)
     writer.saveFile(bookmarkFile, pBmk);
 }
 
+PositionData* createLastmark(int playOrder)
+{
+    std::string zeroPadStr = createZeroPaddedString(playOrder);
+    PositionData* pPd = new PositionData();
+    pPd->mPlayOrder = playOrder;
+    pPd->mUri = zeroPadStr;
+    pPd->mNcxRef = zeroPadStr;
+    pPd->mTextRef = zeroPadStr;
+    pPd->mAudioRef = zeroPadStr;
+    return pPd;
+}
+
 void verifyBoomark(std::string bookmarkFile, int playOrder)
 {
     BookmarkFile* pBmk = NULL;
@@ -142,6 +155,45 @@ int main(int argc, char *argv[])
         verifyBoomark(bookmarkFile, playOrder);
     }
 
+    // lastmarks set in quick succession are written together, the long
+    // interval keeps the writer thread from saving before flush
+    LastmarkWriter* pWriter = new LastmarkWriter();
+    pWriter->setFlushInterval(60000);
+    pWriter->start(bookmarkFile, pBmk);
+    for (int playOrder=100; playOrder<200; playOrder++)
+    {
+        pWriter->setLastmark(createLastmark(playOrder));
+    }
+    assert(pWriter->getNumberOfWrites() == 0);
+
+    // flush writes a pending lastmark at once, and nothing when clean
+    assert(pWriter->flush());
+    assert(pWriter->getNumberOfWrites() == 1);
+    verifyBoomark(bookmarkFile, 199);
+    assert(pWriter->flush());
+    assert(pWriter->getNumberOfWrites() == 1);
+
+    // the writer thread saves a lastmark by itself after the flush interval
+    pWriter->setFlushInterval(200);
+    pWriter->setLastmark(createLastmark(300));
+    for (int i=0; i<1000 && pWriter->getNumberOfWrites() < 2; i++)
+    {
+        usleep(10000);
+    }
+    assert(pWriter->getNumberOfWrites() == 2);
+    verifyBoomark(bookmarkFile, 300);
+
+    // stop writes a pending lastmark before the file is detached
+    pWriter->setLastmark(createLastmark(400));
+    pWriter->stop();
+    assert(pWriter->getNumberOfWrites() == 3);
+    verifyBoomark(bookmarkFile, 400);
+
+    // lastmarks are dropped while no file is attached
+    pWriter->setLastmark(createLastmark(500));
+    assert(pBmk->getLastmark()->mPlayOrder == 400);
+    delete pWriter;
+
     remove(c_bookmarkFile);
     delete pBmk;
 
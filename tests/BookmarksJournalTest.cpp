@@ -0,0 +1,231 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "BookmarksJournal.h"
+#include "BookmarksReader.h"
+#include "BookmarksWriter.h"
+#include "LastmarkWriter.h"
+#include "setup_logging.h"
+
+using namespace amis;
+
+const int numBookmarks = 2000;
+const char* bookmarkFile = "./journal.bmk";
+const char* journalFile = "./journal.bmk.journal";
+
+double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+PositionData* createPosition(int playOrder)
+{
+    std::ostringstream oss;
+    oss << playOrder;
+    PositionData* pPd = new PositionData();
+    pPd->mPlayOrder = playOrder;
+    pPd->mUri = "content.smil#par_" + oss.str();
+    pPd->mNcxRef = "nav_" + oss.str();
+    pPd->mTextRef = "txt_" + oss.str();
+    pPd->mAudioRef = "audio_" + oss.str();
+    return pPd;
+}
+
+Bookmark* createBookmark(int id)
+{
+    Bookmark* pBmk = new Bookmark();
+    pBmk->mId = id;
+    pBmk->mpStart = createPosition(id);
+
+    // note texts may hold the characters the journal escapes
+    MediaGroup* pNote = new MediaGroup();
+    TextNode* pText = new TextNode();
+    pText->setTextString("note\twith\\odd\ncharacters");
+    pNote->setText(pText);
+    AudioNode* pAudio = new AudioNode();
+    pAudio->setSrc("audio.mp3");
+    pAudio->setClipBegin("npt=1.000s");
+    pAudio->setClipEnd("npt=2.000s");
+    pNote->addAudioClip(pAudio);
+    pBmk->mpNote = pNote;
+    pBmk->mbHasNote = true;
+    return pBmk;
+}
+
+// read the bookmark file and apply its journal, like a new session would
+BookmarkFile* openBookmarks(unsigned int& numRecords)
+{
+    BookmarkFile* pFile = new BookmarkFile();
+    BookmarksReader reader;
+    assert(reader.openFile(bookmarkFile, pFile).getCode() == OK);
+
+    BookmarksJournal journal;
+    assert(journal.open(bookmarkFile, pFile).getCode() == OK);
+    numRecords = journal.getNumberOfRecords();
+    return pFile;
+}
+
+// check the bookmarks left after deleting the one at index 5
+void verifyBookmarks(BookmarkFile* pFile)
+{
+    assert(pFile->getNumberOfItems() == numBookmarks - 1);
+    assert(pFile->getMaxId() == numBookmarks);
+    for (int i = 0; i < pFile->getNumberOfItems(); i++)
+    {
+        Bookmark* pBmk = (Bookmark*) pFile->getItem(i);
+        int id = i < 5 ? i + 1 : i + 2;
+        assert(pBmk->mId == id);
+        PositionData* pPos = createPosition(id);
+        assert(pBmk->mpStart->compare(pPos));
+        delete pPos;
+        assert(pBmk->mbHasNote);
+        assert(pBmk->mpNote->getText()->getTextString() == "note\twith\\odd\ncharacters");
+        assert(pBmk->mpNote->getAudio(0)->getClipEnd() == "npt=2.000s");
+    }
+    assert(pFile->getLastmark() != NULL);
+    assert(pFile->getLastmark()->mPlayOrder == 4242);
+}
+
+int main(int argc, char *argv[])
+{
+    setup_logging();
+
+    remove(bookmarkFile);
+    remove(journalFile);
+
+    // an empty bookmark file
+    BookmarkFile* pFile = new BookmarkFile();
+    MediaGroup* pTitle = new MediaGroup();
+    TextNode* pText = new TextNode();
+    pText->setTextString("The title of the book");
+    pTitle->setText(pText);
+    pFile->setTitle(pTitle);
+    pFile->setUid("The uid of the book");
+    BookmarksWriter writer;
+    assert(writer.saveFile(bookmarkFile, pFile));
+
+    // starting the journal writes the file once for a new generation
+    LastmarkWriter* pWriter = new LastmarkWriter();
+    pWriter->setJournal(true);
+    pWriter->setJournalLimit(100000);
+    pWriter->setFlushInterval(60000);
+    pWriter->start(bookmarkFile, pFile);
+    assert(pWriter->getNumberOfWrites() == 1);
+    assert(pFile->getJournalGeneration() == 1);
+
+    // each bookmark is one appended record
+    double start = now();
+    for (int id = 1; id <= numBookmarks; id++)
+    {
+        assert(pWriter->addBookmark(createBookmark(id)));
+    }
+    double add = (now() - start) / numBookmarks;
+    assert(pWriter->getNumberOfWrites() == 1 + numBookmarks);
+
+    assert(pWriter->deleteItem(5));
+    pWriter->setLastmark(createPosition(4242));
+    assert(pWriter->flush());
+    assert(pWriter->getNumberOfWrites() == 3 + numBookmarks);
+
+    // the file itself is untouched, a new session gets it all from the journal
+    BookmarkFile* pSnapshot = new BookmarkFile();
+    BookmarksReader reader;
+    assert(reader.openFile(bookmarkFile, pSnapshot).getCode() == OK);
+    assert(pSnapshot->getNumberOfItems() == 0);
+    delete pSnapshot;
+
+    unsigned int records = 0;
+    start = now();
+    BookmarkFile* pReopened = openBookmarks(records);
+    double reopen = (now() - start) / 1000.0;
+    assert(records == numBookmarks + 2);
+    verifyBookmarks(pReopened);
+    delete pReopened;
+
+    // a record cut short by a power cut is dropped
+    {
+        std::ofstream out(journalFile, std::ios::app);
+        out << "D\t0";
+    }
+    pReopened = openBookmarks(records);
+    assert(records == numBookmarks + 2);
+    verifyBookmarks(pReopened);
+    delete pReopened;
+
+    // stopping writes the whole file and starts an empty journal
+    pWriter->stop();
+    assert(pFile->getJournalGeneration() == 2);
+    pReopened = openBookmarks(records);
+    assert(records == 0);
+    assert(pReopened->getJournalGeneration() == 2);
+    verifyBookmarks(pReopened);
+    delete pReopened;
+
+    // a journal of an older generation is already in the file
+    {
+        std::ofstream out(journalFile, std::ios::trunc);
+        out << "J\t1\nC\n";
+    }
+    pReopened = openBookmarks(records);
+    assert(records == 0);
+    verifyBookmarks(pReopened);
+    delete pReopened;
+
+    // the journal is applied and removed when it is turned off
+    {
+        std::ofstream out(journalFile, std::ios::trunc);
+        out << "J\t2\nC\n";
+    }
+    BookmarkFile* pFile2 = new BookmarkFile();
+    assert(reader.openFile(bookmarkFile, pFile2).getCode() == OK);
+    pWriter->setJournal(false);
+    pWriter->start(bookmarkFile, pFile2);
+    assert(pFile2->getNumberOfItems() == 0);
+    assert(access(journalFile, F_OK) != 0);
+    pWriter->stop();
+    delete pFile2;
+
+    pFile2 = new BookmarkFile();
+    assert(reader.openFile(bookmarkFile, pFile2).getCode() == OK);
+    assert(pFile2->getNumberOfItems() == 0);
+    assert(pFile2->getLastmark()->mPlayOrder == 4242);
+    delete pFile2;
+
+    delete pWriter;
+    delete pFile;
+    remove(bookmarkFile);
+    remove(journalFile);
+
+    std::cout << "bookmarks: " << numBookmarks << std::endl;
+    std::cout << "add: " << add << " us/bookmark" << std::endl;
+    std::cout << "reopen: " << reopen << " ms" << std::endl;
+
+    return 0;
+}
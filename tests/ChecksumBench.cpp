@@ -0,0 +1,85 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <assert.h>
+#include <sys/time.h>
+#include "MetadataSet.h"
+#include "md5.h"
+#include "setup_logging.h"
+
+using namespace amis;
+
+const int rounds = 50;
+
+double now()
+{
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+int main(int argc, char *argv[])
+{
+    setup_logging();
+
+    if( argc < 2 )
+    {
+        std::cerr << "usage: " << argv[0] << " <ncc.html or opf>" << std::endl;
+        return -1;
+    }
+    std::string path = argv[1];
+
+    // book identity from the metadata, the book file is parsed each time
+    std::string metadata;
+    double start = now();
+    for( int i = 0; i < rounds; i++ )
+    {
+        MetadataSet set;
+        assert( set.openBookFile( path ).getCode() == OK );
+        std::string checksum = set.getChecksum();
+        assert( checksum.size() == 32 );
+        assert( metadata.empty() || checksum == metadata );
+        metadata = checksum;
+    }
+    double parsed = ( now() - start ) / rounds;
+
+    // book identity from the file bytes, mapped and hashed without parsing
+    std::string content;
+    start = now();
+    for( int i = 0; i < rounds; i++ )
+    {
+        std::string checksum = md5file( path );
+        assert( content.empty() || checksum == content );
+        content = checksum;
+    }
+    double mapped = ( now() - start ) / rounds;
+
+    std::ifstream in( path.c_str(), std::ios::in | std::ios::binary );
+    std::string bytes( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+    assert( content == md5( bytes ) );
+
+    std::cout << path << " (" << bytes.size() << " bytes)" << std::endl;
+    std::cout << "metadata checksum: " << parsed << " us, content checksum: " << mapped << " us" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <sys/time.h>
+
+#include "Media.h"
+
+using namespace amis;
+
+const int numParses = 1000000;
+
+double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+int main(int argc, char *argv[])
+{
+    // smil 2.0 full and partial clock values
+    assert(AudioNode::clockValueToMs("02:30:03") == 9003000);
+    assert(AudioNode::clockValueToMs("50:00:10.25") == 180010250);
+    assert(AudioNode::clockValueToMs("02:33") == 153000);
+    assert(AudioNode::clockValueToMs("00:10.5") == 10500);
+    assert(AudioNode::clockValueToMs("0:00:04.0625") == 4063);
+
+    // timecounts, seconds unless a unit is given
+    assert(AudioNode::clockValueToMs("3.2h") == 11520000);
+    assert(AudioNode::clockValueToMs("45min") == 2700000);
+    assert(AudioNode::clockValueToMs("30s") == 30000);
+    assert(AudioNode::clockValueToMs("5ms") == 5);
+    assert(AudioNode::clockValueToMs("12.467") == 12467);
+    assert(AudioNode::clockValueToMs("1.5s") == 1500);
+    assert(AudioNode::clockValueToMs("0.0005s") == 1);
+
+    // smil 1.0 clip values
+    assert(AudioNode::clockValueToMs("npt=12.345s") == 12345);
+    assert(AudioNode::clockValueToMs("npt=0:01:02.5") == 62500);
+    assert(AudioNode::clockValueToMs("smpte=00:01:02:15") == 62500);
+    assert(AudioNode::clockValueToMs("smpte-30-drop=00:00:01:03.1") == 1100);
+    assert(AudioNode::clockValueToMs("smpte-25=00:00:01:05") == 1200);
+    assert(AudioNode::clockValueToMs(" npt=2s ") == 2000);
+
+    // not clock values
+    assert(AudioNode::clockValueToMs("") == -1);
+    assert(AudioNode::clockValueToMs("npt=") == -1);
+    assert(AudioNode::clockValueToMs("abc") == -1);
+    assert(AudioNode::clockValueToMs("12.s") == -1);
+    assert(AudioNode::clockValueToMs("12sec") == -1);
+    assert(AudioNode::clockValueToMs("1:2:3:4") == -1);
+    assert(AudioNode::clockValueToMs("smpte=00:01:02") == -1);
+    assert(AudioNode::clockValueToMs("02:33min") == -1);
+
+    // long digit runs are rejected instead of overflowing
+    assert(AudioNode::clockValueToMs("999999999ms") == 999999999);
+    assert(AudioNode::clockValueToMs("1000000000ms") == -1);
+    assert(AudioNode::clockValueToMs("npt=99999999999999999999999999s") == -1);
+    assert(AudioNode::clockValueToMs("00:00:123456789012345678901234") == -1);
+    assert(AudioNode::clockValueToMs("smpte=00:00:01:99999999999999999999") == -1);
+
+    // clip times are parsed when they are set
+    AudioNode audio;
+    assert(audio.getClipBeginMs() == -1);
+    audio.setClipBegin("npt=1.000s");
+    audio.setClipEnd("npt=2.5s");
+    assert(audio.getClipBeginMs() == 1000);
+    assert(audio.getClipEndMs() == 2500);
+    AudioNode* pCopy = audio.copySelf();
+    assert(pCopy->getClipEndMs() == 2500);
+    delete pCopy;
+
+    long long sum = 0;
+    double start = now();
+    for (int i = 0; i < numParses; i++)
+    {
+        sum += AudioNode::clockValueToMs("npt=1234.567s");
+    }
+    double parse = (now() - start) * 1000.0 / numParses;
+    assert(sum == 1234567LL * numParses);
+
+    std::cout << "parse: " << parse << " ns/value" << std::endl;
+
+    return 0;
+}
@@ -159,9 +159,8 @@ int main(int argc, char *argv[])
     //dh->openBook("/mnt/tmp/VBL_2007-06-10/ncc.html");
     //dh->openBook("/mnt/tmp/victor/ncc.html");
 
-    while (dh->getState() == DaisyHandler::HANDLER_OPENING)
+    while (dh->waitForOpen(100) == DaisyHandler::HANDLER_OPENING)
     {
-        usleep(100000);
         printf(".");
         fflush (stdout);
     }
@@ -68,8 +68,7 @@ bool EOSFunction()
 bool openBook(DaisyHandler *dh, std::string book)
 {
     dh->openBook(book);
-    while(dh->getState() == DaisyHandler::HANDLER_OPENING) {
-        usleep(500000);
+    while(dh->waitForOpen(500) == DaisyHandler::HANDLER_OPENING) {
         printf("."); fflush(stdout);
     }
 
@@ -21,6 +21,8 @@
 #include <assert.h>
 #include <unistd.h>
 #include "DaisyHandler.h"
+#include "NavParse.h"
+#include "NavModel.h"
 #include "setup_logging.h"
 
 using namespace amis;
@@ -39,11 +41,7 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    while(DaisyHandler::Instance()->getState() == DaisyHandler::HANDLER_OPENING) {
-        usleep(1000);
-    }
-
-    if(DaisyHandler::Instance()->getState() != DaisyHandler::HANDLER_OPEN) {
+    if(DaisyHandler::Instance()->waitForOpen() != DaisyHandler::HANDLER_OPEN) {
         std::cout << "The file " << argv[1] << " could not be open, please check for errors" << std::endl;
         DaisyHandler::Instance()->DestroyInstance();
         return 1;
@@ -104,9 +102,15 @@ int main(int argc, char *argv[])
     totalPages += bookInfo->mFrontPages;
     totalPages += bookInfo->mNormalPages;
     totalPages += bookInfo->mSpecialPages;
+    NavModel* navModel = NavParse::Instance()->getNavModel();
     assert(DaisyHandler::Instance()->firstPage());
     for (int i=0; i<totalPages-1; i++)
     {
+        // looking up the current page must not move the page list
+        int pageIdx = DaisyHandler::Instance()->currentPage();
+        assert(pageIdx >= 0);
+        // the index counts the pages in play order
+        assert(navModel->getPageInPlayOrder(pageIdx)->getPlayOrder() <= navModel->getPlayOrder());
         pageBefore = DaisyHandler::Instance()->getCurrentPage();
         assert(DaisyHandler::Instance()->nextPage());
         pageAfter = DaisyHandler::Instance()->getCurrentPage();
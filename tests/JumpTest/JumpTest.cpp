@@ -112,9 +112,8 @@ int main(int argc, char *argv[])
     dh = DaisyHandler::Instance();
     dh->openBook(argv[1]);
 
-    while (dh->getState() == DaisyHandler::HANDLER_OPENING)
+    while (dh->waitForOpen(100) == DaisyHandler::HANDLER_OPENING)
     {
-        usleep(100000);
         printf(".");
         fflush (stdout);
     }
@@ -0,0 +1,110 @@
+/*
+ Copyright (C) 2012 Kolibre
+ 
+ This file is part of Kolibre-amis.
+ 
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+ 
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <assert.h>
+#include <sys/time.h>
+#include "PageList.h"
+#include "PageTarget.h"
+
+using namespace amis;
+
+// The linear scans that previousBasedOnPlayOrder and nextBasedOnPlayOrder
+// used to do, kept here as the reference
+NavNode* linearNext( std::vector<NavNode*>& nodes, int playOrder )
+{
+    NavNode* p_found = NULL;
+    for( unsigned int i = 0; i < nodes.size(); i++ )
+        if( nodes[i]->getPlayOrder() > playOrder && ( p_found == NULL || nodes[i]->getPlayOrder() < p_found->getPlayOrder() ) )
+            p_found = nodes[i];
+    return p_found != NULL ? p_found : nodes.back();
+}
+
+NavNode* linearPrevious( std::vector<NavNode*>& nodes, int playOrder )
+{
+    NavNode* p_found = NULL;
+    for( unsigned int i = 0; i < nodes.size(); i++ )
+        if( nodes[i]->getPlayOrder() < playOrder && ( p_found == NULL || nodes[i]->getPlayOrder() > p_found->getPlayOrder() ) )
+            p_found = nodes[i];
+    return p_found != NULL ? p_found : nodes.front();
+}
+
+double now()
+{
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+int main(int argc, char *argv[])
+{
+    srand( 1 );
+
+    PageList empty;
+    assert( empty.nextBasedOnPlayOrder( 0 ) == NULL );
+    assert( empty.previousBasedOnPlayOrder( 0 ) == NULL );
+
+    for( int size = 100; size <= 100000; size *= 10 )
+    {
+        // pages are spread out between the headings, some share a play order
+        PageList list;
+        std::vector<NavNode*> nodes;
+        for( int i = 0; i < size; i++ )
+        {
+            PageTarget* p_page = new PageTarget();
+            p_page->setPlayOrder( 3 * i - ( i % 7 == 0 ? 3 : 0 ) );
+            list.addNode( p_page );
+            nodes.push_back( p_page );
+        }
+
+        // keep the linear reference from dominating the run time
+        const int calls = size < 100000 ? 2000 : 200;
+        std::vector<int> queries;
+        for( int i = 0; i < calls; i++ )
+            queries.push_back( rand() % ( 3 * size + 2 ) - 1 );
+
+        // results must match the linear scan
+        for( int i = 0; i < calls; i++ )
+        {
+            assert( list.nextBasedOnPlayOrder( queries[i] ) == linearNext( nodes, queries[i] ) );
+            assert( list.previousBasedOnPlayOrder( queries[i] ) == linearPrevious( nodes, queries[i] ) );
+        }
+
+        double start = now();
+        for( int i = 0; i < calls; i++ )
+        {
+            list.nextBasedOnPlayOrder( queries[i] );
+            list.previousBasedOnPlayOrder( queries[i] );
+        }
+        double indexed = ( now() - start ) * 1000.0 / ( 2 * calls );
+
+        start = now();
+        for( int i = 0; i < calls; i++ )
+        {
+            linearNext( nodes, queries[i] );
+            linearPrevious( nodes, queries[i] );
+        }
+        double linear = ( now() - start ) * 1000.0 / ( 2 * calls );
+
+        std::cout << "pages: " << size << " indexed: " << indexed << " ns/call, linear: " << linear << " ns/call" << std::endl;
+    }
+
+    return 0;
+}
@@ -20,7 +20,11 @@
 #include <iostream>
 #include <assert.h>
 #include <unistd.h>
+#include <vector>
 #include "DaisyHandler.h"
+#include "NavParse.h"
+#include "NavMap.h"
+#include "NavModel.h"
 #include "setup_logging.h"
 
 using namespace amis;
@@ -39,11 +43,7 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    while(DaisyHandler::Instance()->getState() == DaisyHandler::HANDLER_OPENING) {
-        usleep(1000);
-    }
-
-    if(DaisyHandler::Instance()->getState() != DaisyHandler::HANDLER_OPEN) {
+    if(DaisyHandler::Instance()->waitForOpen() != DaisyHandler::HANDLER_OPEN) {
         std::cout << "The file " << argv[1] << " could not be open, please check for errors" << std::endl;
         DaisyHandler::Instance()->DestroyInstance();
         return 1;
@@ -97,6 +97,48 @@ int main(int argc, char *argv[])
         assert(DaisyHandler::Instance()->goToId(navPoints->sections[i].id));
     }
 
+    // sync to each nav point by play order and check that walking on from
+    // there gives the same nodes as walking from the first node
+    std::cout << "trying sync to each nav point by play order" << std::endl;
+    NavMap* navMap = NavParse::Instance()->getNavModel()->getNavMap();
+    std::vector<NavPoint*> walk;
+    for(NavPoint* p = (NavPoint*)navMap->first(); p != NULL; p = (NavPoint*)navMap->next())
+        walk.push_back(p);
+    for(unsigned int i=0; i<walk.size(); i++)
+    {
+        // play orders may repeat, the first node in the walk is returned
+        unsigned int j = 0;
+        while(walk[j]->getPlayOrder() != walk[i]->getPlayOrder())
+            j++;
+        assert(navMap->syncNearestPlayOrder(walk[i]->getPlayOrder()) == walk[j]);
+        assert(navMap->syncPlayOrder(walk[i]->getPlayOrder()) == walk[j]);
+        NavPoint* p_next = (NavPoint*)navMap->next();
+        assert(p_next == (j+1 < walk.size() ? walk[j+1] : NULL));
+    }
+    if(walk.size() > 0)
+        assert(navMap->syncPlayOrder(walk.back()->getPlayOrder() + 1) == NULL);
+
+    // look up the section and page index of each play order
+    std::cout << "trying section and page index lookups" << std::endl;
+    NavModel* navModel = NavParse::Instance()->getNavModel();
+    assert(navModel->getNumberOfSections() == (int)walk.size());
+    for(unsigned int i=0; i<walk.size(); i++)
+    {
+        unsigned int j = 0;
+        while(walk[j]->getPlayOrder() != walk[i]->getPlayOrder())
+            j++;
+        assert(navModel->getSectionIndex(walk[i]->getPlayOrder()) == (int)j+1);
+    }
+    PageList* pageList = navModel->getPageList();
+    for(int i=0; i<pageList->getLength(); i++)
+    {
+        int playOrder = pageList->getPage(i)->getPlayOrder();
+        int expected = -1;
+        for(int j=0; j<pageList->getLength(); j++)
+            if(pageList->getPage(j)->getPlayOrder() <= playOrder)
+                expected++;
+        assert(navModel->getPageIndex(playOrder) == expected);
+    }
 
     // cleanup before exit
     DaisyHandler::Instance()->closeBook();
@@ -39,11 +39,7 @@ int main(int argc, char *argv[])
         exit(1);
     }
 
-    while(DaisyHandler::Instance()->getState() == DaisyHandler::HANDLER_OPENING) {
-        usleep(1000);
-    }
-
-    if(DaisyHandler::Instance()->getState() != DaisyHandler::HANDLER_OPEN) {
+    if(DaisyHandler::Instance()->waitForOpen() != DaisyHandler::HANDLER_OPEN) {
         std::cout << "The file " << argv[1] << " could not be open, please check for errors" << std::endl;
         DaisyHandler::Instance()->DestroyInstance();
         return 1;
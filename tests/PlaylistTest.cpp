@@ -0,0 +1,181 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <assert.h>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "DaisyHandler.h"
+#include "NavParse.h"
+#include "NavModel.h"
+#include "SmilEngine.h"
+#include "SmilTreePrefetcher.h"
+#include "setup_logging.h"
+
+using namespace amis;
+
+const unsigned int lookahead = 5;
+
+struct PlayedClip
+{
+    std::string file;
+    long long startms;
+    long long stopms;
+};
+std::vector<PlayedClip> played;
+
+// record the clips the handler plays, times are in milliseconds
+bool play(std::string file, long long startms, long long stopms, void* data)
+{
+    PlayedClip clip;
+    clip.file = file;
+    clip.startms = startms;
+    clip.stopms = stopms;
+    played.push_back(clip);
+    return true;
+}
+
+bool sameItems(const std::vector<DaisyHandler::PlaylistItem>& a,
+        const std::vector<DaisyHandler::PlaylistItem>& b)
+{
+    if(a.size() != b.size())
+        return false;
+    for(unsigned int i=0; i<a.size(); i++)
+    {
+        if(a[i].file != b[i].file || a[i].startms != b[i].startms
+                || a[i].stopms != b[i].stopms || a[i].textId != b[i].textId
+                || a[i].playOrder != b[i].playOrder)
+            return false;
+    }
+    return true;
+}
+
+// get the playlist once the smil files it looks into are parsed, they are
+// parsed in the background and a call before that returns fewer clips
+void lookAhead(std::vector<DaisyHandler::PlaylistItem>& items)
+{
+    DaisyHandler* handler = DaisyHandler::Instance();
+    SmilTreePrefetcher* prefetcher = SmilEngine::Instance()->getPrefetcher();
+
+    std::vector<DaisyHandler::PlaylistItem> again;
+    assert(handler->getPlaylist(lookahead, items));
+    while(items.size() < lookahead)
+    {
+        while(not prefetcher->isIdle())
+            usleep(1000);
+
+        assert(handler->getPlaylist(lookahead, again));
+        if(sameItems(items, again))
+            break;
+        items = again;
+    }
+}
+
+// walk the book phrase by phrase and check that each phrase plays the
+// clips the playlist promised, returns the number of phrases
+int walkBook()
+{
+    DaisyHandler* handler = DaisyHandler::Instance();
+    NavModel* navModel = NavParse::Instance()->getNavModel();
+
+    handler->firstSection();
+
+    int phrases = 0;
+    std::vector<DaisyHandler::PlaylistItem> items;
+    std::vector<DaisyHandler::PlaylistItem> again;
+    lookAhead(items);
+    assert(items.size() <= lookahead);
+
+    while(true)
+    {
+        // looking ahead does not move the position
+        lookAhead(again);
+        assert(sameItems(items, again));
+
+        unsigned int before = played.size();
+        if(not handler->nextPhrase())
+        {
+            assert(items.empty());
+            break;
+        }
+        phrases++;
+
+        unsigned int count = played.size() - before;
+        assert(count > 0 && count <= items.size());
+        for(unsigned int i=0; i<count; i++)
+        {
+            assert(played[before + i].file == items[i].file);
+            assert(played[before + i].startms == items[i].startms);
+            assert(played[before + i].stopms == items[i].stopms);
+        }
+        assert(navModel->getPlayOrder() == items[count - 1].playOrder);
+
+        lookAhead(items);
+    }
+
+    return phrases;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2) {
+        std::cout << "Please specify an ncc.html file on the command line" << std::endl;
+        return -1;
+    }
+
+    setup_logging();
+
+    DaisyHandler::Instance()->setPlayFunction(play, NULL);
+
+    if(not DaisyHandler::Instance()->openBook(argv[1])) {
+        std::cout << "Unable to open requested file: " << argv[1] << std::endl;;
+        return 1;
+    }
+
+    if(DaisyHandler::Instance()->waitForOpen() != DaisyHandler::HANDLER_OPEN) {
+        std::cout << "The file " << argv[1] << " could not be open, please check for errors" << std::endl;
+        DaisyHandler::Instance()->DestroyInstance();
+        return 1;
+    }
+
+    DaisyHandler::Instance()->setupBook();
+
+    int phrases = walkBook();
+    std::cout << "Walked " << phrases << " phrases" << std::endl;
+    assert(phrases > 0);
+
+    // the playlist leaves out the structures that are turned off
+    int tests = DaisyHandler::Instance()->numCustomTests();
+    if(tests > 0)
+    {
+        for(int i=0; i<tests; i++)
+            DaisyHandler::Instance()->setCustomTestState(i, false);
+
+        int skipped = walkBook();
+        std::cout << "Walked " << skipped << " phrases with " << tests << " skippable structures off" << std::endl;
+        assert(skipped <= phrases);
+    }
+
+    // cleanup before exit
+    DaisyHandler::Instance()->closeBook();
+    DaisyHandler::Instance()->DestroyInstance();
+
+    return 0;
+}
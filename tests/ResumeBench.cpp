@@ -0,0 +1,208 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+#include <sys/time.h>
+#include "SmilEngine.h"
+#include "CustomTest.h"
+#include "setup_logging.h"
+
+using namespace amis;
+
+double now()
+{
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+bool hasAudioId( SmilMediaGroup* media, const std::string& id )
+{
+    for( unsigned int i = 0; i < media->getNumberOfAudioClips(); i++ )
+        if( media->getAudio( i )->getId() == id )
+            return true;
+    return false;
+}
+
+// Step through the file from the top until the clip plays, how
+// loadSmilContent used to resume an audio ref
+SmilMediaGroup* replayTo( const std::string& smilPath, const std::string& id )
+{
+    SmilMediaGroup* media = new SmilMediaGroup();
+    SmilEngine::Instance()->loadPosition( smilPath, media );
+    delete media;
+    media = new SmilMediaGroup();
+    AmisError err = SmilEngine::Instance()->first( media );
+    while( err.getCode() == OK && not hasAudioId( media, id ) )
+    {
+        delete media;
+        media = new SmilMediaGroup();
+        err = SmilEngine::Instance()->next( media );
+        if( SmilEngine::Instance()->getSmilSourcePath() != smilPath )
+            break;
+    }
+    return media;
+}
+
+// The audio clips with an id in a smil file, in playback order
+void collectIds( const std::string& smilPath, std::vector<std::string>& ids )
+{
+    SmilMediaGroup* media = new SmilMediaGroup();
+    AmisError err = SmilEngine::Instance()->loadPosition( smilPath, media );
+    while( err.getCode() == OK && SmilEngine::Instance()->getSmilSourcePath() == smilPath )
+    {
+        for( unsigned int j = 0; j < media->getNumberOfAudioClips(); j++ )
+            if( not media->getAudio( j )->getId().empty() )
+                ids.push_back( media->getAudio( j )->getId() );
+        delete media;
+        media = new SmilMediaGroup();
+        err = SmilEngine::Instance()->next( media );
+    }
+    delete media;
+}
+
+// Look the clip up in the id index of the file
+SmilMediaGroup* seekTo( const std::string& smilPath, const std::string& id )
+{
+    SmilMediaGroup* media = new SmilMediaGroup();
+    SmilEngine::Instance()->loadPosition( smilPath, media );
+    delete media;
+    media = new SmilMediaGroup();
+    AmisError err = SmilEngine::Instance()->goToAudioId( id, media );
+    assert( err.getCode() == OK );
+    return media;
+}
+
+int main(int argc, char *argv[])
+{
+    setup_logging();
+
+    if( argc < 2 )
+    {
+        std::cerr << "usage: " << argv[0] << " <ncc.html or opf>" << std::endl;
+        return -1;
+    }
+
+    SmilMediaGroup* media = new SmilMediaGroup();
+    assert( SmilEngine::Instance()->openBook( argv[1], media ).getCode() == OK );
+    delete media;
+
+    // the skippable structures of the test books, rendered for now, opening
+    // the book clears the skip options so they are added after it
+    const char* skippable[] = { "pagenumber", "pagenum", "prodnote", "sidebar" };
+    const int numSkippable = sizeof( skippable ) / sizeof( skippable[0] );
+    for( int i = 0; i < numSkippable; i++ )
+    {
+        amis::CustomTest option;
+        option.setId( skippable[i] );
+        option.setCurrentState( true );
+        option.setDefaultState( true );
+        SmilEngine::Instance()->addSkipOption( &option );
+    }
+
+    int clips = 0;
+    double replay = 0;
+    double seek = 0;
+    double worstReplay = 0;
+    double worstSeek = 0;
+
+    std::vector< std::vector<std::string> > allIds;
+    for( int i = 0; i < SmilEngine::Instance()->getNumberOfSmilFiles(); i++ )
+    {
+        std::string smilPath = SmilEngine::Instance()->getSmilFilePath( i );
+
+        std::vector<std::string> ids;
+        collectIds( smilPath, ids );
+        allIds.push_back( ids );
+
+        for( unsigned int j = 0; j < ids.size(); j++ )
+        {
+            double start = now();
+            media = replayTo( smilPath, ids[j] );
+            double took = now() - start;
+            assert( hasAudioId( media, ids[j] ) );
+            delete media;
+            replay += took;
+            worstReplay = took > worstReplay ? took : worstReplay;
+
+            start = now();
+            media = seekTo( smilPath, ids[j] );
+            took = now() - start;
+            assert( hasAudioId( media, ids[j] ) );
+            delete media;
+            seek += took;
+            worstSeek = took > worstSeek ? took : worstSeek;
+
+            clips++;
+        }
+    }
+
+    // turn the skippable structures off, a clip inside one must not be
+    // played when it is resumed, the next group that is played is
+    int skipped = 0;
+    for( int i = 0; i < numSkippable; i++ )
+        SmilEngine::Instance()->changeSkipOption( skippable[i], false );
+
+    for( int i = 0; i < SmilEngine::Instance()->getNumberOfSmilFiles(); i++ )
+    {
+        std::string smilPath = SmilEngine::Instance()->getSmilFilePath( i );
+
+        std::vector<std::string> played;
+        collectIds( smilPath, played );
+
+        for( unsigned int j = 0; j < allIds[i].size(); j++ )
+        {
+            const std::string& id = allIds[i][j];
+            if( std::find( played.begin(), played.end(), id ) != played.end() )
+                continue;
+
+            media = new SmilMediaGroup();
+            SmilEngine::Instance()->loadPosition( smilPath, media );
+            delete media;
+            media = new SmilMediaGroup();
+            AmisError err = SmilEngine::Instance()->goToAudioId( id, media );
+            assert( err.getCode() == OK || err.getCode() == AT_END );
+            if( err.getCode() == OK )
+            {
+                assert( not hasAudioId( media, id ) );
+                assert( media->getNumberOfAudioClips() > 0 );
+            }
+            delete media;
+            skipped++;
+        }
+    }
+
+    SmilEngine::Instance()->closeBook();
+    SmilEngine::Instance()->DestroyInstance();
+
+    std::cout << argv[1] << std::endl;
+    std::cout << "audio refs: " << clips << std::endl;
+    std::cout << "skipped audio refs: " << skipped << std::endl;
+    if( clips > 0 )
+    {
+        std::cout << "replay: " << replay / clips << " us/resume, worst " << worstReplay << " us" << std::endl;
+        std::cout << "seek: " << seek / clips << " us/resume, worst " << worstSeek << " us" << std::endl;
+    }
+
+    return 0;
+}
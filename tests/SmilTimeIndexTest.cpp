@@ -0,0 +1,205 @@
+/*
+ Copyright (C) 2012 Kolibre
+ 
+ This file is part of Kolibre-amis.
+ 
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+ 
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <assert.h>
+#include <unistd.h>
+#include "DaisyHandler.h"
+#include "SmilEngine.h"
+#include "SmilTimeIndex.h"
+#include "setup_logging.h"
+
+using namespace amis;
+
+unsigned int indexedFiles = 0;
+unsigned int totalFiles = 0;
+int prescanData = 0;
+
+void onPrescanProgress( unsigned int indexed, unsigned int total, void* data )
+{
+    assert( data == &prescanData );
+    indexedFiles = indexed;
+    totalFiles = total;
+}
+
+unsigned int openCalls = 0;
+bool openResult = false;
+
+void onOpen( bool opened )
+{
+    openCalls++;
+    openResult = opened;
+}
+
+bool findSmilAt( SmilTimeIndex* index, unsigned long ms )
+{
+    int smilIdx, clipIdx;
+    unsigned long clipOffset;
+
+    if( not index->lookup( ms, smilIdx, clipIdx, clipOffset ) )
+    {
+        std::cout << __PRETTY_FUNCTION__ << ": no file contains ms : " << ms << std::endl;
+        return false;
+    }
+
+    const SmilTimeIndex::SmilEntry* entry = index->getSmilEntry( smilIdx );
+    assert( entry != NULL );
+    assert( entry->mStart <= ms || smilIdx == 0 );
+    if( smilIdx + 1 < (int)index->getNumberOfSmilFiles() )
+        assert( index->getSmilEntry( smilIdx + 1 )->mStart > ms );
+
+    if( clipIdx >= 0 )
+    {
+        const SmilTimeIndex::ClipEntry& clip = entry->mClips[clipIdx];
+        assert( clip.mNumTextIds <= entry->mTextIds.size() );
+        assert( clipOffset <= clip.mClipEnd - clip.mClipBegin );
+        std::cout << "Smil file: " << entry->mSmilPath << " clip: " << clip.mAudioId << " contains " << ms << " ms position" << std::endl;
+    }
+
+    return true;
+}
+
+// Seeking to a time in a smil file must land on the clip the index has there
+void checkClipSeek( SmilTimeIndex* index )
+{
+    for( unsigned int i = 0; i < index->getNumberOfSmilFiles(); i++ )
+    {
+        const SmilTimeIndex::SmilEntry* entry = index->getSmilEntry( i );
+        for( unsigned int j = 0; j < entry->mClips.size(); j++ )
+        {
+            const SmilTimeIndex::ClipEntry& clip = entry->mClips[j];
+            unsigned long duration = clip.mClipEnd - clip.mClipBegin;
+            if( duration == 0 )
+                continue;
+
+            SmilMediaGroup media;
+            unsigned long clipOffset = 0;
+            std::vector<std::string> textIds;
+            AmisError err = SmilEngine::Instance()->loadTime( entry->mSmilPath,
+                    clip.mOffset + duration / 2, &media, clipOffset, textIds );
+            assert( err.getCode() == OK );
+            assert( media.getNumberOfAudioClips() > 0 );
+
+            // clips may have no id, so match the clip begin as well
+            bool found = false;
+            for( unsigned int k = 0; k < media.getNumberOfAudioClips(); k++ )
+            {
+                AudioNode* audio = media.getAudio( k );
+                found = found || ( audio->getId() == clip.mAudioId &&
+                        SmilTimeIndex::clockValueToMs( audio->getClipBegin() ) == (long)clip.mClipBegin );
+            }
+            assert( found );
+            assert( clipOffset == duration / 2 );
+            assert( textIds.size() == clip.mNumTextIds );
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2) {
+        std::cout << "Please specify an ncc.html file on the command line" << std::endl;
+        exit(-1);
+    }
+
+    setup_logging();
+
+    // The book is indexed after it has been opened by default
+    DaisyHandler::Instance()->setPrescanFunction(onPrescanProgress, &prescanData);
+    DaisyHandler::Instance()->setOpenFunction(onOpen);
+
+    if(not DaisyHandler::Instance()->openBook(argv[1])) {
+        std::cout << "Unable to open requested file: " << argv[1] << std::endl;;
+        exit(1);
+    }
+
+    if(DaisyHandler::Instance()->waitForOpen() != DaisyHandler::HANDLER_OPEN) {
+        std::cout << "The file " << argv[1] << " could not be open, please check for errors" << std::endl;
+        DaisyHandler::Instance()->DestroyInstance();
+        return 1;
+    }
+
+    DaisyHandler::Instance()->setupBook();
+
+    // The open thread is joined by setupBook, so the callback has been made
+    assert( openCalls == 1 );
+    assert( openResult );
+
+    SmilTimeIndex* index = SmilEngine::Instance()->getTimeIndex();
+    for( int i = 0; i < 60000 && not index->isReady(); i++ ) {
+        usleep(1000);
+    }
+    assert( index->isReady() );
+    assert( indexedFiles == totalFiles );
+    assert( indexedFiles == index->getNumberOfSmilFiles() );
+    assert( index->findSmilFile( index->getSmilEntry( 0 )->mSmilPath ) == 0 );
+    assert( index->getNumberOfSmilFiles() == (unsigned int)SmilEngine::Instance()->getNumberOfSmilFiles() );
+
+    // Start offsets must be increasing
+    for( unsigned int i = 1; i < index->getNumberOfSmilFiles(); i++ )
+        assert( index->getSmilEntry( i - 1 )->mStart <= index->getSmilEntry( i )->mStart );
+
+    unsigned long total = index->getTotalDuration();
+    std::cout << "Total duration: " << total << " ms" << std::endl;
+
+    // Test out-of-bound positions
+    assert( ! findSmilAt( index, total + 100000 ) );
+    assert( ! findSmilAt( index, (unsigned long)-1 ) );
+
+    // Test border positions
+    assert( findSmilAt( index, 0 ) );
+    assert( findSmilAt( index, total ) );
+
+    // Test positions inside book
+    assert( findSmilAt( index, total / 10 ) );
+    assert( findSmilAt( index, total / 2 ) );
+
+    checkClipSeek( index );
+
+    // Jumping through the index should load a position
+    assert( DaisyHandler::Instance()->jumpToSecond( total / 2000 ) );
+
+    // The index is dropped with the book
+    DaisyHandler::Instance()->closeBook();
+    assert( ! index->isReady() );
+
+    // Closing joined a finished prescan, the next one must not be cancelled
+    indexedFiles = 0;
+    assert( DaisyHandler::Instance()->openBook(argv[1]) );
+    assert( DaisyHandler::Instance()->waitForOpen() == DaisyHandler::HANDLER_OPEN );
+    for( int i = 0; i < 60000 && not index->isReady(); i++ ) {
+        usleep(1000);
+    }
+    assert( index->isReady() );
+    assert( indexedFiles == totalFiles );
+    DaisyHandler::Instance()->closeBook();
+
+    // Without the background prescan the index is ready when the book is open
+    DaisyHandler::Instance()->setBackgroundPrescan(false);
+    indexedFiles = 0;
+    assert( DaisyHandler::Instance()->openBook(argv[1]) );
+    assert( DaisyHandler::Instance()->waitForOpen() == DaisyHandler::HANDLER_OPEN );
+    assert( index->isReady() );
+    assert( indexedFiles == totalFiles );
+    DaisyHandler::Instance()->closeBook();
+
+    DaisyHandler::Instance()->DestroyInstance();
+
+    return 0;
+}
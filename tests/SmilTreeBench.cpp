@@ -0,0 +1,183 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "SmilTree.h"
+#include "SmilTreeBuilder.h"
+#include "TimeContainerNode.h"
+#include "SmilMediaGroup.h"
+#include "SmilMediaGroupPool.h"
+
+using namespace amis;
+
+const int numPars = 10000;
+const char* smilFile = "smiltreebench.smil";
+
+// Write a DAISY 2.02 style smil file with all pars under one seq
+void writeSmil( const char* path, int pars )
+{
+    std::ofstream out( path );
+    out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>" << std::endl;
+    out << "<smil>" << std::endl;
+    out << "<head><meta name=\"dc:format\" content=\"Daisy 2.02\"/></head>" << std::endl;
+    out << "<body><seq id=\"root\">" << std::endl;
+    for( int i = 0; i < pars; i++ )
+    {
+        out << "<par endsync=\"last\" id=\"par_" << i << "\">";
+        out << "<text src=\"content.html#txt_" << i << "\" id=\"txt_" << i << "\"/>";
+        out << "<seq><audio src=\"audio.mp3\" clip-begin=\"npt=" << i << ".000s\" clip-end=\"npt="
+            << i + 1 << ".000s\" id=\"audio_" << i << "\"/></seq>";
+        out << "</par>" << std::endl;
+    }
+    out << "</seq></body></smil>" << std::endl;
+}
+
+// Child lookup by walking the sibling list, how getChild used to work
+Node* siblingChild( TimeContainerNode* pNode, int index )
+{
+    Node* p_child = index < pNode->NumChildren() ? pNode->getChild( 0 ) : NULL;
+    for( int i = 0; i < index && p_child != NULL; i++ )
+        p_child = p_child->getFirstSibling();
+    return p_child;
+}
+
+double now()
+{
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+int main(int argc, char *argv[])
+{
+    writeSmil( smilFile, numPars );
+
+    // build the tree
+    double start = now();
+    SmilTreeBuilder builder;
+    builder.setDaisyVersion( DAISY202 );
+    SmilTree* tree = new SmilTree();
+    AmisError err = builder.createSmilTree( tree, smilFile );
+    assert( err.getCode() == OK );
+    double build = ( now() - start ) / 1000.0;
+
+    TimeContainerNode* root = (TimeContainerNode*) tree->getRoot();
+    assert( root != NULL );
+    assert( root->NumChildren() == numPars );
+
+    // indexed access and the sibling walk find the same children
+    for( int i = 0; i < numPars; i += 97 )
+        assert( root->getChild( i ) == siblingChild( root, i ) );
+    assert( root->getChild( numPars ) == NULL );
+
+    start = now();
+    long found = 0;
+    for( int i = 0; i < numPars; i++ )
+        found += root->getChild( i ) != NULL;
+    double indexed = ( now() - start ) * 1000.0 / numPars;
+    assert( found == numPars );
+
+    // walking the sibling list for each index is quadratic, sample it
+    const int samples = 200;
+    start = now();
+    for( int i = 0; i < samples; i++ )
+        found += siblingChild( root, i * ( numPars / samples ) ) != NULL;
+    double sibling = ( now() - start ) * 1000.0 / samples;
+
+    // play every par from first to last, the media nodes belong to the tree
+    SmilMediaGroup* media = new SmilMediaGroup();
+    start = now();
+    int played = 0;
+    err = tree->goFirst( media );
+    while( err.getCode() == OK )
+    {
+        played++;
+        delete media;
+        media = new SmilMediaGroup();
+        err = tree->goNext( media );
+    }
+    double walk = ( now() - start ) / 1000.0;
+    assert( played == numPars );
+
+    // the same walk filling one group from the pool again and again
+    SmilMediaGroupPool pool;
+    SmilMediaGroup* reused = pool.take();
+    start = now();
+    played = 0;
+    err = tree->goFirst( reused );
+    while( err.getCode() == OK )
+    {
+        played++;
+        err = tree->goNext( reused );
+    }
+    double reuse = ( now() - start ) / 1000.0;
+    assert( played == numPars );
+
+    // a refilled group holds only the par it was last filled with
+    err = tree->goFirst( reused );
+    for( int i = 0; i < 100; i++ )
+    {
+        std::ostringstream id;
+        id << "audio_" << i;
+        assert( err.getCode() == OK );
+        assert( reused->getNumberOfAudioClips() == 1 );
+        assert( reused->getAudio( 0 )->getId() == id.str() );
+        err = tree->goNext( reused );
+    }
+    pool.give( reused );
+    assert( pool.take() == reused );
+    assert( reused->getNumberOfAudioClips() == 0 && !reused->hasText() );
+    pool.give( reused );
+    assert( pool.getNumberOfCreatedGroups() == 1 );
+
+    // jump to pars spread through the file
+    start = now();
+    for( int i = 0; i < samples; i++ )
+    {
+        std::ostringstream id;
+        id << "par_" << i * ( numPars / samples );
+        delete media;
+        media = new SmilMediaGroup();
+        err = tree->goToId( id.str(), media );
+        assert( err.getCode() == OK );
+    }
+    double jump = ( now() - start ) / samples;
+    delete media;
+
+    start = now();
+    delete tree;
+    double destroy = ( now() - start ) / 1000.0;
+
+    unlink( smilFile );
+
+    std::cout << "pars: " << numPars << std::endl;
+    std::cout << "build: " << build << " ms" << std::endl;
+    std::cout << "getChild: " << indexed << " ns/call, sibling walk: " << sibling << " ns/call" << std::endl;
+    std::cout << "goNext over all pars: " << walk << " ms, reusing a group: " << reuse << " ms" << std::endl;
+    std::cout << "goToId: " << jump << " us/call" << std::endl;
+    std::cout << "delete: " << destroy << " ms" << std::endl;
+
+    return 0;
+}
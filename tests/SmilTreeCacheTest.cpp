@@ -0,0 +1,153 @@
+/*
+ Copyright (C) 2012 Kolibre
+ 
+ This file is part of Kolibre-amis.
+ 
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+ 
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <assert.h>
+#include <unistd.h>
+#include "DaisyHandler.h"
+#include "SmilEngine.h"
+#include "SmilEngineConstants.h"
+#include "SmilTreeCache.h"
+#include "SmilTreePrefetcher.h"
+#include "setup_logging.h"
+
+using namespace amis;
+
+// Move one phrase at a time until another smil file is loaded
+bool changeSmilFile( bool forward )
+{
+    std::string current = SmilEngine::Instance()->getSmilSourcePath();
+
+    while( SmilEngine::Instance()->getSmilSourcePath() == current )
+    {
+        bool moved = forward ? DaisyHandler::Instance()->nextPhrase() : DaisyHandler::Instance()->previousPhrase();
+        if( not moved )
+            return false;
+    }
+
+    std::cout << "Smil file: " << SmilEngine::Instance()->getSmilSourcePath() << std::endl;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2) {
+        std::cout << "Please specify an ncc.html file on the command line" << std::endl;
+        exit(-1);
+    }
+
+    setup_logging();
+
+    if(not DaisyHandler::Instance()->openBook(argv[1])) {
+        std::cout << "Unable to open requested file: " << argv[1] << std::endl;;
+        exit(1);
+    }
+
+    if(DaisyHandler::Instance()->waitForOpen() != DaisyHandler::HANDLER_OPEN) {
+        std::cout << "The file " << argv[1] << " could not be open, please check for errors" << std::endl;
+        DaisyHandler::Instance()->DestroyInstance();
+        return 1;
+    }
+
+    DaisyHandler::Instance()->setupBook();
+
+    // The engine keeps the current and the previous tree itself, so a book
+    // needs three smil files before one of its trees goes to the cache
+    if( SmilEngine::Instance()->getNumberOfSmilFiles() < 3 )
+    {
+        DaisyHandler::Instance()->closeBook();
+        DaisyHandler::Instance()->DestroyInstance();
+        return 0;
+    }
+
+    // Start at the beginning, the lastmark may be near the end of the book
+    DaisyHandler::Instance()->firstSection();
+
+    // Only count the trees cached by navigation
+    SmilEngine::Instance()->setPrefetchNext(false);
+    SmilEngine::Instance()->getPrefetcher()->stop();
+
+    SmilTreeCache* cache = SmilEngine::Instance()->getTreeCache();
+    cache->clear();
+    cache->resetCounters();
+
+    // Step forward into the next smil file, nothing is cached yet
+    assert( changeSmilFile( true ) );
+    assert( cache->getHits() == 0 );
+
+    // Stepping back and forth between neighbours should not parse again
+    std::string second = SmilEngine::Instance()->getSmilSourcePath();
+    assert( changeSmilFile( false ) );
+    assert( cache->getHits() == 1 );
+    assert( changeSmilFile( true ) );
+    assert( SmilEngine::Instance()->getSmilSourcePath() == second );
+    assert( cache->getHits() == 2 );
+
+    std::cout << "Hits: " << cache->getHits() << " misses: " << cache->getMisses() << " trees: " << cache->getNumberOfTrees() << " bytes: " << cache->getMemoryUsage() << std::endl;
+
+    // Moving on to a third file puts the first tree in the cache
+    assert( changeSmilFile( true ) );
+    assert( cache->getNumberOfTrees() > 0 );
+
+    // The bounds are enforced
+    assert( cache->getMemoryUsage() > 0 );
+    cache->setMaxMemory( 1 );
+    assert( cache->getNumberOfTrees() == 0 );
+    assert( cache->getMemoryUsage() == 0 );
+    cache->setMaxMemory( CACHE_MAX_MEMORY );
+
+    // With the cache disabled every change is a miss
+    cache->setMaxTrees( 0 );
+    cache->resetCounters();
+    assert( changeSmilFile( false ) );
+    assert( changeSmilFile( true ) );
+    assert( cache->getHits() == 0 );
+    cache->setMaxTrees( CACHE_MAX_TREES );
+
+    // The next file is built while the current one plays
+    SmilEngine::Instance()->setPrefetchNext(true);
+    assert( changeSmilFile( true ) );
+    int current = -1;
+    for( int i = 0; i < SmilEngine::Instance()->getNumberOfSmilFiles(); i++ )
+        if( SmilEngine::Instance()->getSmilFilePath( i ) == SmilEngine::Instance()->getSmilSourcePath() )
+            current = i;
+    assert( current >= 0 );
+    if( current + 1 < SmilEngine::Instance()->getNumberOfSmilFiles() )
+    {
+        std::string next = SmilEngine::Instance()->getSmilFilePath( current + 1 );
+        for( int i = 0; i < 10000 && not cache->isCached( next ); i++ )
+            usleep(1000);
+        assert( cache->isCached( next ) );
+        assert( SmilEngine::Instance()->getPrefetcher()->getNumberOfBuiltTrees() > 0 );
+
+        // Playing into the next file picks up the prefetched tree
+        cache->resetCounters();
+        while( SmilEngine::Instance()->getSmilSourcePath() != next )
+            assert( DaisyHandler::Instance()->nextPhrase() );
+        assert( cache->getHits() == 1 );
+    }
+
+    // The cache is dropped with the book
+    DaisyHandler::Instance()->closeBook();
+    assert( cache->getNumberOfTrees() == 0 );
+
+    DaisyHandler::Instance()->DestroyInstance();
+
+    return 0;
+}
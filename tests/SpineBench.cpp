@@ -0,0 +1,102 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <assert.h>
+#include <sys/time.h>
+#include "AmisError.h"
+#include "Spine.h"
+
+const int numFiles = 5000;
+
+std::string smilPath( int i )
+{
+    std::ostringstream oss;
+    oss << "/books/Big_Book/smil_" << i << ".smil";
+    return oss.str();
+}
+
+double now()
+{
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+int main(int argc, char *argv[])
+{
+    Spine spine;
+    assert( spine.isEmpty() );
+
+    // each par of a DAISY 2.02 book adds its smil file again
+    double start = now();
+    for( int i = 0; i < numFiles; i++ )
+    {
+        spine.addFile( smilPath( i ) + "#par_1" );
+        spine.addFile( smilPath( i ) + "#par_2" );
+    }
+    double build = ( now() - start ) / 1000.0;
+
+    assert( spine.getNumberOfSmilFiles() == numFiles );
+    for( int i = 0; i < numFiles; i += 101 )
+        assert( spine.getSmilFilePath( i ) == smilPath( i ) );
+
+    // lookups ignore targets, case and the direction of slashes
+    assert( spine.isFilePresent( smilPath( 42 ) ) );
+    assert( spine.isFilePresent( "\\books\\big_book\\SMIL_42.SMIL#id" ) );
+    assert( not spine.isFilePresent( "/books/Big_Book/smil_5000.smil" ) );
+    assert( not spine.isFilePresent( "/books/Big_Book/mil_42.smil" ) );
+    assert( not spine.isFilePresent( "/other/books/Big_Book/smil_42.smil" ) );
+
+    assert( spine.goToFile( "/BOOKS/big_book/smil_1234.smil#par_9" ) );
+    assert( spine.getCurrentIndex() == 1234 );
+    assert( spine.getStatus() == amis::OK );
+    assert( spine.getNextFile() == smilPath( 1235 ) );
+    assert( not spine.goToFile( "/books/Big_Book/smil_1234.mp3" ) );
+    assert( spine.getCurrentIndex() == 1235 );
+
+    start = now();
+    for( int i = numFiles - 1; i >= 0; i-- )
+    {
+        assert( spine.goToFile( smilPath( i ) ) );
+        assert( spine.getCurrentIndex() == (unsigned int) i );
+    }
+    double lookup = ( now() - start ) * 1000.0 / numFiles;
+
+    spine.freeSpineList();
+    assert( spine.isEmpty() );
+    assert( not spine.isFilePresent( smilPath( 0 ) ) );
+
+    // a path that is only a target is kept whole, like clearTarget does
+    spine.addFile( "#par_1" );
+    spine.addFile( "#par_2" );
+    assert( spine.getNumberOfSmilFiles() == 2 );
+    assert( spine.getSmilFilePath( 0 ) == "#par_1" );
+    assert( spine.isFilePresent( "#PAR_2" ) );
+    assert( not spine.isFilePresent( "" ) );
+    spine.freeSpineList();
+
+    std::cout << "smil files: " << numFiles << std::endl;
+    std::cout << "build: " << build << " ms" << std::endl;
+    std::cout << "goToFile: " << lookup << " ns/call" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+/*
+ Copyright (C) 2012 Kolibre
+
+ This file is part of Kolibre-amis.
+
+ Kolibre-amis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 2.1 of the License, or
+ (at your option) any later version.
+
+ Kolibre-amis is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with Kolibre-amis.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <set>
+#include <sstream>
+#include <iostream>
+#include <assert.h>
+#include <pthread.h>
+
+#include "Media.h"
+#include "StringPool.h"
+#include "DaisyHandler.h"
+#include "SmilEngine.h"
+#include "setup_logging.h"
+
+using namespace amis;
+
+const int numThreads = 4;
+const int numFiles = 500;
+
+const std::string* pooled[numThreads][numFiles];
+
+std::string fileName(int i)
+{
+    std::ostringstream oss;
+    oss << "audio_file_of_the_book_" << i << ".mp3";
+    return oss.str();
+}
+
+// each thread interns the same file names, like trees built in parallel
+void* intern_thread(void* arg)
+{
+    long thread = (long) arg;
+    for (int i = 0; i < numFiles; i++)
+    {
+        pooled[thread][i] = StringPool::Instance()->intern(fileName(i));
+    }
+    return NULL;
+}
+
+// open the book, read every phrase from start to end and close it again,
+// the text srcs of the phrases are added to textSrcs
+void readBook(const char* book, std::set<std::string>& textSrcs)
+{
+    assert(DaisyHandler::Instance()->openBook(book));
+    assert(DaisyHandler::Instance()->waitForOpen() == DaisyHandler::HANDLER_OPEN);
+    DaisyHandler::Instance()->setupBook();
+
+    SmilMediaGroup* media = new SmilMediaGroup();
+    AmisError err = SmilEngine::Instance()->loadPosition(SmilEngine::Instance()->getSmilFilePath(0), media);
+    while (err.getCode() == OK)
+    {
+        if (media->hasText())
+            textSrcs.insert(media->getText()->getSrc());
+        delete media;
+        media = new SmilMediaGroup();
+        err = SmilEngine::Instance()->next(media);
+    }
+    delete media;
+
+    DaisyHandler::Instance()->closeBook();
+}
+
+int main(int argc, char *argv[])
+{
+    StringPool* pPool = StringPool::Instance();
+
+    // equal strings are pooled once
+    std::string name = "bagw0001.mp3";
+    const std::string* pName = pPool->intern(name);
+    assert(*pName == name);
+    assert(pPool->intern("bagw0001.mp3") == pName);
+    assert(pPool->intern("bagw0002.mp3") != pName);
+    assert(pPool->intern("") == pPool->getEmpty());
+
+    // media nodes share the pooled copy, the id is their own
+    AudioNode audio;
+    assert(audio.getSrc() == "");
+    audio.setSrc(name);
+    audio.setRegionId("txtView");
+    audio.setId("aud_0001");
+    audio.setClipBegin("npt=0.000s");
+    audio.setClipEnd("npt=1.500s");
+    AudioNode other;
+    other.setSrc("bagw0001.mp3");
+    assert(&other.getSrc() == &audio.getSrc());
+    assert(&other.getSrc() == pName);
+
+    AudioNode* pCopy = audio.copySelf();
+    assert(&pCopy->getSrc() == pName);
+    assert(&pCopy->getRegionId() == &audio.getRegionId());
+    assert(pCopy->getId() == "aud_0001");
+    assert(pCopy->getClipEndMs() == 1500);
+    pCopy->setSrc("bagw0002.mp3");
+    assert(audio.getSrc() == "bagw0001.mp3");
+    delete pCopy;
+
+    // threads interning the same strings get the same copies
+    unsigned int size = pPool->getNumberOfStrings();
+    pthread_t threads[numThreads];
+    for (long t = 0; t < numThreads; t++)
+    {
+        assert(pthread_create(&threads[t], NULL, intern_thread, (void*) t) == 0);
+    }
+    for (int t = 0; t < numThreads; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+    assert(pPool->getNumberOfStrings() == size + numFiles);
+    for (int i = 0; i < numFiles; i++)
+    {
+        assert(*pooled[0][i] == fileName(i));
+        for (int t = 1; t < numThreads; t++)
+        {
+            assert(pooled[t][i] == pooled[0][i]);
+        }
+    }
+
+    // text srcs point at single elements and are kept by the node
+    size = pPool->getNumberOfStrings();
+    TextNode text;
+    text.setSrc("chapter_01.html#par_0001");
+    assert(text.getSrc() == "chapter_01.html#par_0001");
+    MediaNode* pMedia = &text;
+    pMedia->setSrc("chapter_01.html#par_0002");
+    assert(pMedia->getSrc() == "chapter_01.html#par_0002");
+    assert(pPool->getNumberOfStrings() == size);
+
+    std::cout << "pooled strings: " << pPool->getNumberOfStrings() << std::endl;
+    std::cout << "audio node: " << sizeof(AudioNode) << " bytes" << std::endl;
+
+    if (argc < 2)
+        return 0;
+
+    // opening the same book again does not grow the pool
+    setup_logging();
+    std::set<std::string> textSrcs;
+    readBook(argv[1], textSrcs);
+    size = pPool->getNumberOfStrings();
+    readBook(argv[1], textSrcs);
+    assert(pPool->getNumberOfStrings() == size);
+    std::cout << argv[1] << ": " << size << " pooled strings, "
+            << textSrcs.size() << " text srcs" << std::endl;
+
+    // none of the text srcs of the book were pooled
+    for (std::set<std::string>::iterator it = textSrcs.begin(); it != textSrcs.end(); it++)
+        pPool->intern(*it);
+    assert(pPool->getNumberOfStrings() == size + textSrcs.size());
+
+    DaisyHandler::Instance()->DestroyInstance();
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+#!/bin/sh
+
+if [ -x /usr/bin/gdb ]; then
+    PREFIX="libtool --mode=execute gdb --return-child-result --batch -x ${srcdir:-.}/run --args"
+fi
+
+$PREFIX ./checksumbench ${srcdir:-.}/data/Mountains_skip/ncc.html
+$PREFIX ./checksumbench ${srcdir:-.}/data/Theory_behind_players_kate/ncc.html
+$PREFIX ./checksumbench ${srcdir:-.}/data/Chimpanzees_DAISY_3.0/Chimpanzees.opf
+$PREFIX ./checksumbench ${srcdir:-.}/data/VBL20120911/speechgen.opf
@@ -20,10 +20,41 @@
 #include "md5.h"
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <cstdio>
 #include <assert.h>
 
 int main(int argc, char *argv[]) {
     std::string hash = md5("grape");
     assert(hash.compare("b781cbb29054db12f88f08c6e161c199")==0);
+
+    // feeding the text in pieces gives the same digest
+    std::string text;
+    for (int i = 0; i < 1000; i++)
+        text.append("name=content\n");
+    MD5 hasher;
+    for (unsigned int i = 0; i < text.size(); i += 7)
+        hasher.update(text.substr(i, 7));
+
+    // a finalized copy leaves the original open for more input
+    MD5 copy = hasher;
+    assert(copy.finalize().hexdigest() == md5(text));
+    hasher.update("grape");
+    assert(hasher.finalize().hexdigest() == md5(text + "grape"));
+
+    // file checksums match the checksum of the content
+    const char* file = "./md5test.txt";
+    {
+        std::ofstream out(file);
+        out << text;
+    }
+    assert(md5file(file) == md5(text));
+    {
+        std::ofstream out(file, std::ios::trunc);
+    }
+    assert(md5file(file) == md5(""));
+    remove(file);
+    assert(md5file(file) == "");
+
     return 0;
 }
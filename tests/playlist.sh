@@ -0,0 +1,11 @@
+#!/bin/sh
+
+if [ -x /usr/bin/gdb ]; then
+    PREFIX="libtool --mode=execute gdb --return-child-result --batch -x ${srcdir:-.}/run --args"
+fi
+
+$PREFIX ./playlist ${srcdir:-.}/data/Mountains_skip/ncc.html
+$PREFIX ./playlist ${srcdir:-.}/data/Theory_behind_players_kate/ncc.html
+$PREFIX ./playlist ${srcdir:-.}/data/Chimpanzees_DAISY_3.0/Chimpanzees.opf
+$PREFIX ./playlist ${srcdir:-.}/data/VBL20120911/speechgen.opf
+$PREFIX ./playlist ${srcdir:-.}/data/FireSafety/ncc.html
@@ -0,0 +1,10 @@
+#!/bin/sh
+
+if [ -x /usr/bin/gdb ]; then
+    PREFIX="libtool --mode=execute gdb --return-child-result --batch -x ${srcdir:-.}/run --args"
+fi
+
+$PREFIX ./smiltimeindex ${srcdir:-.}/data/Mountains_skip/ncc.html
+$PREFIX ./smiltimeindex ${srcdir:-.}/data/Theory_behind_players_kate/ncc.html
+$PREFIX ./smiltimeindex ${srcdir:-.}/data/Chimpanzees_DAISY_3.0/Chimpanzees.opf
+$PREFIX ./smiltimeindex ${srcdir:-.}/data/VBL20120911/speechgen.opf
@@ -0,0 +1,10 @@
+#!/bin/sh
+
+if [ -x /usr/bin/gdb ]; then
+    PREFIX="libtool --mode=execute gdb --return-child-result --batch -x ${srcdir:-.}/run --args"
+fi
+
+$PREFIX ./smiltreecache ${srcdir:-.}/data/Mountains_skip/ncc.html
+$PREFIX ./smiltreecache ${srcdir:-.}/data/Theory_behind_players_kate/ncc.html
+$PREFIX ./smiltreecache ${srcdir:-.}/data/Chimpanzees_DAISY_3.0/Chimpanzees.opf
+$PREFIX ./smiltreecache ${srcdir:-.}/data/VBL20120911/speechgen.opf
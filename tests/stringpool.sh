@@ -0,0 +1,9 @@
+#!/bin/sh
+
+if [ -x /usr/bin/gdb ]; then
+    PREFIX="libtool --mode=execute gdb --return-child-result --batch -x ${srcdir:-.}/run --args"
+fi
+
+$PREFIX ./stringpool ${srcdir:-.}/data/Mountains_skip/ncc.html
+$PREFIX ./stringpool ${srcdir:-.}/data/Chimpanzees_DAISY_3.0/Chimpanzees.opf
+$PREFIX ./stringpool ${srcdir:-.}/data/VBL20120911/speechgen.opf